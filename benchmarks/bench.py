@@ -0,0 +1,346 @@
+#!/usr/bin/env python3
+r'''
+Benchmarks for pysseract: throughput, latency and peak memory of the main code paths on synthetic pages.
+
+Pages are generated locally from the text lines of the sample images in tests/, at the requested sizes,
+resolutions and text densities, so the suite needs nothing but an installed pysseract and the traineddata
+Tesseract already uses. Results are written as JSON to compare releases:
+
+.. code-block:: bash
+
+    python benchmarks/bench.py --output before.json
+    python benchmarks/bench.py --output after.json --only recognition scaling
+'''
+import argparse
+import json
+import os
+import platform
+import resource
+import sys
+import tempfile
+import time
+from concurrent.futures import ThreadPoolExecutor
+from pathlib import Path
+
+import numpy
+
+# one Tesseract thread per engine, so that the scaling benchmark measures pysseract rather than OpenMP
+os.environ.setdefault('OMP_THREAD_LIMIT', '1')
+
+import pysseract  # noqa: E402
+
+SAMPLES = Path(__file__).resolve().parent.parent / 'tests'
+
+# name: (width, height) in inches
+PAGE_SIZES = {
+    'a6': (4.1, 5.8),
+    'a5': (5.8, 8.3),
+    'letter': (8.5, 11.0),
+}
+
+LEVELS = ['BLOCK', 'PARA', 'TEXTLINE', 'WORD', 'SYMBOL']
+
+BENCHMARKS = ['recognition', 'iterat', 'export', 'ingestion', 'scaling']
+
+
+def resetPeakRss():
+    '''Restart the peak RSS high-water mark where the kernel allows it (Linux). Returns whether it did.'''
+    try:
+        with open('/proc/self/clear_refs', 'w') as f:
+            f.write('5')
+        return True
+    except OSError:
+        return False
+
+
+def peakRss():
+    '''Peak resident set size in bytes since the last resetPeakRss, or since the process started.'''
+    try:
+        with open('/proc/self/status') as f:
+            for line in f:
+                if line.startswith('VmHWM:'):
+                    return int(line.split()[1]) * 1024
+    except OSError:
+        pass
+    peak = resource.getrusage(resource.RUSAGE_SELF).ru_maxrss
+    return peak if sys.platform == 'darwin' else peak * 1024
+
+
+def toGray(pixels):
+    if pixels.ndim == 3:
+        pixels = pixels[:, :, :3].mean(axis=2)
+    return numpy.ascontiguousarray(pixels, dtype=numpy.uint8)
+
+
+def sampleLines(datapath, language):
+    '''Grayscale crops of every text line in the bundled sample images.'''
+    t = pysseract.Pysseract(datapath, language)
+    lines = []
+    for name, ppi in (('001-helloworld.png', 0), ('002-quick-fox.jpg', 70)):
+        t.SetImageFromPath((SAMPLES / name).as_posix())
+        t.pageSegMode = pysseract.PageSegMode.SINGLE_BLOCK
+        if ppi:
+            t.SetSourceResolution(ppi)
+        gray = toGray(t.GetInputImageArray())
+        cols = t.ExtractLevel(pysseract.PageIteratorLevel.TEXTLINE, ['box'])
+        for left, top, width, height in zip(cols['left'], cols['top'], cols['width'], cols['height']):
+            if width > 0 and height > 0:
+                lines.append(gray[top:top + height, left:left + width])
+    t.End()
+    if not lines:
+        raise RuntimeError('No text lines found in the sample images; is the traineddata installed?')
+    return lines
+
+
+def scaleTo(line, height):
+    '''Nearest-neighbour resize of a line crop to `height` pixels, keeping its aspect ratio.'''
+    width = max(1, int(round(line.shape[1] * height / line.shape[0])))
+    rows = (numpy.arange(height) * line.shape[0] // height).clip(0, line.shape[0] - 1)
+    cols = (numpy.arange(width) * line.shape[1] // width).clip(0, line.shape[1] - 1)
+    return line[numpy.ix_(rows, cols)]
+
+
+def makePage(lines, size, dpi, density, rng):
+    '''
+    A white page of the given size and resolution with lines of roughly 12pt text. `density` is the share of the
+    line slots that hold text, each filled with sample lines from the left margin up to the right margin.
+    '''
+    widthIn, heightIn = PAGE_SIZES[size]
+    width, height = int(widthIn * dpi), int(heightIn * dpi)
+    page = numpy.full((height, width), 255, numpy.uint8)
+    lineHeight = max(8, dpi // 6)
+    margin = dpi // 2
+    for y in range(margin, height - margin - lineHeight, int(lineHeight * 1.5)):
+        if rng.random_sample() >= density:
+            continue
+        x = margin
+        while True:
+            line = scaleTo(lines[rng.randint(len(lines))], lineHeight)
+            if x + line.shape[1] > width - margin:
+                break
+            page[y:y + lineHeight, x:x + line.shape[1]] = line
+            x += line.shape[1] + lineHeight
+    return page
+
+
+class Page:
+    '''A synthetic page as pixels, as PNG bytes and as a file on disk.'''
+
+    def __init__(self, spec, pixels, encoder, directory, index):
+        self.spec = spec
+        self.pixels = pixels
+        encoder.SetImageFromArray(pixels, ppi=spec['dpi'])
+        self.encoded = encoder.GetInputImage()
+        self.path = os.path.join(directory, 'page-{}.png'.format(index))
+        with open(self.path, 'wb') as f:
+            f.write(self.encoded)
+
+
+def makePages(args, directory):
+    rng = numpy.random.RandomState(args.seed)
+    lines = sampleLines(args.datapath, args.language)
+    encoder = pysseract.Pysseract(args.datapath, args.language)
+    pages = []
+    for size in args.sizes:
+        for dpi in args.dpis:
+            for density in args.densities:
+                spec = {'size': size, 'dpi': dpi, 'density': density}
+                for _ in range(args.pages):
+                    pages.append(Page(spec, makePage(lines, size, dpi, density, rng), encoder, directory, len(pages)))
+    encoder.End()
+    return pages
+
+
+def summarise(name, params, latencies, elapsed, peak, peakReset):
+    latencies = numpy.asarray(latencies) * 1000.0
+    return {
+        'benchmark': name,
+        'params': params,
+        'pages': len(latencies),
+        'pages_per_sec': len(latencies) / elapsed if elapsed > 0 else None,
+        'latency_ms': {
+            'p50': float(numpy.percentile(latencies, 50)),
+            'p99': float(numpy.percentile(latencies, 99)),
+            'mean': float(latencies.mean()),
+            'max': float(latencies.max()),
+        },
+        'peak_rss_bytes': peak,
+        'peak_rss_reset': peakReset,
+    }
+
+
+def measure(name, params, pages, setup, step):
+    '''Time `step(page)` for every page, calling `setup(page)` untimed first.'''
+    peakReset = resetPeakRss()
+    latencies = []
+    elapsed = 0.0
+    for page in pages:
+        setup(page)
+        start = time.perf_counter()
+        step(page)
+        latency = time.perf_counter() - start
+        latencies.append(latency)
+        elapsed += latency
+    return summarise(name, params, latencies, elapsed, peakRss(), peakReset)
+
+
+def load(t, page):
+    # PNGs written by Leptonica do not necessarily carry the resolution along
+    t.SetImageFromBytes(page.encoded)
+    t.SetSourceResolution(page.spec['dpi'])
+
+
+def groupBySpec(pages):
+    groups = {}
+    for page in pages:
+        groups.setdefault(json.dumps(page.spec, sort_keys=True), []).append(page)
+    return [(json.loads(key), group) for key, group in sorted(groups.items())]
+
+
+def benchRecognition(t, pages):
+    for spec, group in groupBySpec(pages):
+        yield measure('recognition', spec, group, lambda page: load(t, page), lambda page: t.Recognize())
+
+
+def benchIterAt(t, pages):
+    # recognise each page once and walk it at every level, instead of recognising it again per level
+    levels = [(name, getattr(pysseract.PageIteratorLevel, name)) for name in LEVELS]
+    for spec, group in groupBySpec(pages):
+        peakReset = resetPeakRss()
+        latencies = {name: [] for name, _ in levels}
+        for page in group:
+            load(t, page)
+            t.Recognize()
+            for name, level in levels:
+                start = time.perf_counter()
+                for _ in t.IterAt(level):
+                    pass
+                latencies[name].append(time.perf_counter() - start)
+        peak = peakRss()
+        for name, _ in levels:
+            yield summarise('iterat', dict(spec, level=name), latencies[name], sum(latencies[name]), peak, peakReset)
+
+
+def benchExport(t, pages):
+    exports = {
+        'GetThresholdedImage': lambda page: t.GetThresholdedImage(),
+        'GetInputImage': lambda page: t.GetInputImage(),
+        'GetThresholdedImageArray': lambda page: t.GetThresholdedImageArray(),
+        'GetInputImageArray': lambda page: t.GetInputImageArray(),
+    }
+    for spec, group in groupBySpec(pages):
+        for method, step in exports.items():
+            # the first call thresholds the page; measure the export itself
+            def setup(page):
+                load(t, page)
+                t.GetThresholdedImageArray()
+
+            yield measure('export', dict(spec, method=method), group, setup, step)
+
+
+def benchIngestion(t, pages):
+    sources = {
+        'path': lambda page: t.SetImageFromPath(page.path),
+        'bytes': lambda page: t.SetImageFromBytes(page.encoded),
+        'array': lambda page: t.SetImageFromArray(page.pixels, ppi=page.spec['dpi']),
+    }
+    for spec, group in groupBySpec(pages):
+        for source, step in sources.items():
+            yield measure('ingestion', dict(spec, source=source), group, lambda page: t.Clear(), step)
+
+
+def benchScaling(args, pages):
+    threadCounts = [n for n in (1, 2, 4, 8, 16, 32, 64) if n <= args.max_threads]
+    if args.max_threads not in threadCounts:
+        threadCounts.append(args.max_threads)
+    engines = [pysseract.Pysseract(args.datapath, args.language) for _ in range(args.max_threads)]
+    # every thread count gets the same amount of work per engine, so that pages/sec is comparable
+    work = pages * args.scaling_rounds
+    baseline = None
+    for threads in threadCounts:
+        peakReset = resetPeakRss()
+
+        def run(engine):
+            latencies = []
+            for page in work:
+                start = time.perf_counter()
+                load(engine, page)
+                engine.Recognize()
+                latencies.append(time.perf_counter() - start)
+            return latencies
+
+        start = time.perf_counter()
+        with ThreadPoolExecutor(threads) as executor:
+            results = list(executor.map(run, engines[:threads]))
+        elapsed = time.perf_counter() - start
+        result = summarise('scaling', {'threads': threads}, [lat for lats in results for lat in lats], elapsed,
+                           peakRss(), peakReset)
+        baseline = baseline or result['pages_per_sec']
+        result['speedup'] = result['pages_per_sec'] / baseline
+        yield result
+    for engine in engines:
+        engine.End()
+
+
+def parseArgs(argv):
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument('--output', '-o', help='write the JSON results here instead of stdout')
+    parser.add_argument('--only', nargs='+', choices=BENCHMARKS, default=BENCHMARKS, help='benchmarks to run')
+    parser.add_argument('--sizes', nargs='+', choices=sorted(PAGE_SIZES), default=['a6', 'letter'])
+    parser.add_argument('--dpis', nargs='+', type=int, default=[150, 300])
+    parser.add_argument('--densities', nargs='+', type=float, default=[0.2, 0.8],
+                        help='share of the line slots on a page that hold text')
+    parser.add_argument('--pages', type=int, default=3, help='pages per size, dpi and density')
+    parser.add_argument('--max-threads', type=int, default=os.cpu_count() or 1)
+    parser.add_argument('--scaling-rounds', type=int, default=1,
+                        help='how many times each scaling thread goes through all pages')
+    parser.add_argument('--seed', type=int, default=0)
+    parser.add_argument('--datapath', default=None, help='tessdata directory, default as for Pysseract()')
+    parser.add_argument('--language', default=None)
+    return parser.parse_args(argv)
+
+
+def main(argv=None):
+    args = parseArgs(argv)
+    results = []
+    with tempfile.TemporaryDirectory(prefix='pysseract-bench-') as directory:
+        pages = makePages(args, directory)
+        t = pysseract.Pysseract(args.datapath, args.language)
+        runners = {
+            'recognition': lambda: benchRecognition(t, pages),
+            'iterat': lambda: benchIterAt(t, pages),
+            'export': lambda: benchExport(t, pages),
+            'ingestion': lambda: benchIngestion(t, pages),
+            'scaling': lambda: benchScaling(args, pages),
+        }
+        for name in BENCHMARKS:
+            if name not in args.only:
+                continue
+            for result in runners[name]():
+                print('{benchmark:12} {params} {pages_per_sec:.2f} pages/s, p50 {p50:.1f} ms, p99 {p99:.1f} ms'.format(
+                    p50=result['latency_ms']['p50'], p99=result['latency_ms']['p99'], **result), file=sys.stderr)
+                results.append(result)
+        t.End()
+
+    report = {
+        'meta': {
+            'pysseract': pysseract.__version__,
+            'tesseract': pysseract.apiVersion(),
+            'python': platform.python_version(),
+            'platform': platform.platform(),
+            'cpus': os.cpu_count(),
+            'time': time.strftime('%Y-%m-%dT%H:%M:%S%z'),
+            'args': vars(args),
+        },
+        'results': results,
+    }
+    if args.output:
+        with open(args.output, 'w') as f:
+            json.dump(report, f, indent=2)
+    else:
+        json.dump(report, sys.stdout, indent=2)
+        print()
+
+
+if __name__ == '__main__':
+    main()
@@ -87,6 +87,9 @@ class BuildExt(build_ext):
             if has_flag(self.compiler, '-fvisibility=hidden'):
 
                 opts.append('-fvisibility=hidden')
+            if has_flag(self.compiler, '-pthread'):
+                opts.append('-pthread')
+                link_opts.append('-pthread')
         for ext in self.extensions:
             ext.extra_compile_args = opts
             ext.extra_link_args = link_opts
@@ -138,7 +141,7 @@ if __name__ == "__main__":
         long_description_content_type='text/markdown',
         license='MIT',
         ext_modules=[ext],
-        install_requires=[],
+        install_requires=['numpy'],
         package_dir={'': 'src'},
         packages=find_packages('src', exclude=["*.cpp"]),
         package_data={"vtt_cbd_app": ["assets/*"]},
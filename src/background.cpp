@@ -0,0 +1,58 @@
+#include "background.h"
+
+#include <pybind11/pybind11.h>
+#include <stdexcept>
+#include <utility>
+
+namespace py = pybind11;
+
+BackgroundWorkers &BackgroundWorkers::instance() {
+    // never destroyed: joinable threads must not meet a static destructor if atexit handlers did not run
+    static BackgroundWorkers *workers = new BackgroundWorkers;
+    return *workers;
+}
+
+bool BackgroundWorkers::stopping() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stopping_;
+}
+
+void BackgroundWorkers::submit(std::shared_ptr<RecognitionMonitor> monitor, Job job) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopping_) throw std::runtime_error("pysseract is shutting down");
+    queue_.push_back(Task{std::move(monitor), std::move(job)});
+    if (idle_ < queue_.size()) threads_.emplace_back(&BackgroundWorkers::work, this);
+    cv_.notify_one();
+}
+
+void BackgroundWorkers::shutdown() {
+    std::vector<std::thread> threads;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) return;
+        stopping_ = true;
+        for (auto &&monitor : running_) monitor->Cancel();
+        threads.swap(threads_);
+    }
+    cv_.notify_all();
+    // the jobs take the GIL to drop their Python references
+    py::gil_scoped_release release;
+    for (auto &&thread : threads) thread.join();
+}
+
+void BackgroundWorkers::work() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        idle_++;
+        cv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+        idle_--;
+        if (queue_.empty()) return;
+        Task task = std::move(queue_.front());
+        queue_.pop_front();
+        auto running = running_.insert(running_.end(), task.monitor);
+        lock.unlock();
+        task.job();
+        lock.lock();
+        running_.erase(running);
+    }
+}
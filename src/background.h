@@ -0,0 +1,64 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "monitor.h"
+
+/**
+ * The native threads behind RecognizeAsync and GetTextAsync, owned by the module rather than detached.
+ *
+ * A thread is started whenever a job arrives and no thread is idle, and then stays around for later jobs, so
+ * concurrent async calls still run in parallel. shutdown() is registered with atexit: it cancels whatever is still
+ * recognising and joins every thread while the interpreter is fully alive, so no thread ever takes the GIL during
+ * finalisation.
+ **/
+class BackgroundWorkers {
+   public:
+    /**
+     * Jobs check stopping() before recognising and again, with the GIL held, before reporting back, and once the
+     * module is shutting down only drop their references instead of calling into the event loop.
+     **/
+    using Job = std::function<void()>;
+
+    static BackgroundWorkers &instance();
+
+    /**
+     * Whether shutdown() has started. Once it returns false with the GIL held, shutdown cannot start until the GIL
+     * is released.
+     **/
+    bool stopping();
+
+    /**
+     * Queue `job`, which recognises under `monitor`. Must be called with the GIL held.
+     **/
+    void submit(std::shared_ptr<RecognitionMonitor> monitor, Job job);
+
+    /**
+     * Cancel all running jobs and join the threads. Later submissions are rejected. Must be called with the GIL
+     * held.
+     **/
+    void shutdown();
+
+   private:
+    struct Task {
+        std::shared_ptr<RecognitionMonitor> monitor;
+        Job job;
+    };
+
+    void work();
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Task> queue_;
+    std::list<std::shared_ptr<RecognitionMonitor>> running_;
+    std::vector<std::thread> threads_;
+    size_t idle_ = 0;
+    bool stopping_ = false;
+};
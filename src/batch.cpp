@@ -0,0 +1,374 @@
+#include "batch.h"
+
+#include <leptonica/allheaders.h>
+#include <pybind11/stl.h>
+#include <tesseract/baseapi.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "image.h"
+#include "monitor.h"
+#include "pool.h"
+#include "render.h"
+#include "stats.h"
+
+namespace py = pybind11;
+using tesseract::OcrEngineMode;
+using tesseract::PageSegMode;
+
+namespace {
+
+struct BatchConfig {
+    size_t threads;
+    size_t queueDepth;
+    bool ordered;
+    std::vector<std::string> formats;
+    int pageSegMode;  // negative to keep the engine default
+    int ppi;
+    int timeoutMs;  // per page, 0 for no deadline
+    std::unordered_map<std::string, std::string> variables;
+};
+
+/**
+ * One input page. Paths are decoded with pixRead, 1-D buffers (e.g. bytes) with pixReadMem and 2-D/3-D buffers are
+ * handed to SetImage as raw pixels.
+ **/
+struct BatchItem {
+    enum Kind { PATH, ENCODED, PIXELS } kind;
+    std::string path;
+    std::unique_ptr<py::buffer_info> buffer;  // released with the GIL held when the run is destroyed
+    PixelBuffer pixels;
+};
+
+/**
+ * The work-stealing scheduler behind OcrBatch.run.
+ *
+ * Pages are dealt round-robin into one deque per worker. A worker takes pages from the front of its own deque and,
+ * once that is empty, steals from the other workers' deques. Recognising a page takes milliseconds to seconds, so a
+ * single mutex guarding all deques is nowhere near contended and keeps the back-pressure rules simple: at most
+ * `queueDepth` pages may be in flight or waiting to be consumed (unordered), or ahead of the next page to be
+ * yielded (ordered).
+ **/
+class BatchRun {
+   public:
+    BatchRun(std::shared_ptr<PysseractPool> pool, const BatchConfig &config, std::vector<BatchItem> items,
+             std::shared_ptr<std::atomic<bool>> busy)
+        : pool_(std::move(pool)), config_(config), items_(std::move(items)), busy_(std::move(busy)) {
+        size_t workers = std::min(config_.threads, items_.size());
+        queues_.resize(workers);
+        for (size_t i = 0; i < items_.size(); i++) queues_[i % workers].push_back(i);
+        try {
+            for (size_t w = 0; w < workers; w++) threads_.emplace_back(&BatchRun::work, this, w);
+        } catch (...) {
+            close();
+            throw;
+        }
+    }
+
+    ~BatchRun() { close(); }
+
+    /**
+     * Wait for the next result. Must be called without holding the GIL. Returns false once every page has been
+     * yielded or the run was closed.
+     **/
+    bool next(PageResult &out) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (consumed_ == items_.size()) {
+            // the workers are done too, so the batch may start its next run while this one is still alive
+            releaseBusy();
+            return false;
+        }
+        if (closed_) return false;
+        auto ready = [this] {
+            if (!config_.ordered) return done_.begin();
+            return std::find_if(done_.begin(), done_.end(), [this](const PageResult &r) { return r.index == next_; });
+        };
+        cv_.wait(lock, [&] { return closed_ || ready() != done_.end(); });
+        if (closed_) return false;
+        auto it = ready();
+        out = std::move(*it);
+        done_.erase(it);
+        consumed_++;
+        next_++;
+        lock.unlock();
+        cv_.notify_all();
+        return true;
+    }
+
+    /**
+     * Stop handing out pages, wait for the workers to finish their current page and drop any remaining results.
+     * Must be called with the GIL held.
+     **/
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (closed_) return;
+            closed_ = true;
+        }
+        cv_.notify_all();
+        {
+            py::gil_scoped_release release;
+            for (auto &&thread : threads_) thread.join();
+        }
+        releaseBusy();
+    }
+
+   private:
+    void releaseBusy() {
+        if (!busyReleased_.exchange(true)) busy_->store(false);
+    }
+
+    enum class Take { TAKEN, BLOCKED, EMPTY };
+
+    bool allowed(size_t index) const {
+        if (config_.ordered) return index < next_ + config_.queueDepth;
+        return inFlight_ + done_.size() < config_.queueDepth;
+    }
+
+    // called with mutex_ held
+    Take take(size_t worker, size_t &index) {
+        bool pending = false;
+        for (size_t k = 0; k < queues_.size(); k++) {
+            auto &queue = queues_[(worker + k) % queues_.size()];
+            if (queue.empty()) continue;
+            pending = true;
+            // the owner works front to back; thieves take the newest page, except that ordered runs steal the
+            // oldest one to keep the reorder buffer small
+            bool front = k == 0 || config_.ordered;
+            size_t candidate = front ? queue.front() : queue.back();
+            if (!allowed(candidate)) continue;
+            index = candidate;
+            if (front) {
+                queue.pop_front();
+            } else {
+                queue.pop_back();
+            }
+            return Take::TAKEN;
+        }
+        return pending ? Take::BLOCKED : Take::EMPTY;
+    }
+
+    void work(size_t worker) {
+        Pysseract *api = pool_->acquire();
+        if (config_.pageSegMode >= 0) api->SetPageSegMode(static_cast<PageSegMode>(config_.pageSegMode));
+        for (auto &&entry : config_.variables) api->SetVariable(entry.first.c_str(), entry.second.c_str());
+
+        while (true) {
+            size_t index = 0;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                Take state = Take::EMPTY;
+                cv_.wait(lock, [&] {
+                    state = closed_ ? Take::EMPTY : take(worker, index);
+                    return state != Take::BLOCKED;
+                });
+                if (state == Take::EMPTY) break;
+                inFlight_++;
+            }
+            PageResult result = process(*api, index);
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                inFlight_--;
+                done_.push_back(std::move(result));
+            }
+            cv_.notify_all();
+        }
+        pool_->release(api);
+    }
+
+    PageResult process(Pysseract &api, size_t index) {
+        PageResult result;
+        result.index = index;
+        const BatchItem &item = items_[index];
+        try {
+            if (item.kind == BatchItem::PIXELS) {
+                const PixelBuffer &p = item.pixels;
+                api.SetImage(p.data, p.width, p.height, p.channels, p.bytesPerLine);
+            } else {
+                const size_t size = item.kind == BatchItem::PATH ? 0 : item.buffer->size * item.buffer->itemsize;
+                Pix *pix;
+                {
+                    StageTimer timer(api.Stats(), Stage::DECODE);
+                    pix = item.kind == BatchItem::PATH
+                              ? pixRead(item.path.c_str())
+                              : pixReadMem(static_cast<const l_uint8 *>(item.buffer->ptr), size);
+                }
+                if (pix == nullptr) throw std::runtime_error("Failed to decode the image");
+                if (api.Stats().enabled()) {
+                    api.Stats().add(Counter::BYTES_DECODED,
+                                    item.kind == BatchItem::PATH ? nbytesInFile(item.path.c_str()) : size);
+                }
+                api.SetImage(pix);
+                pixDestroy(&pix);
+            }
+            if (config_.ppi > 0) api.SetSourceResolution(config_.ppi);
+            RecognitionMonitor monitor(config_.timeoutMs);
+            switch (monitor.Recognize(api)) {
+                case RecognitionMonitor::DONE:
+                    break;
+                case RecognitionMonitor::TIMED_OUT:
+                    throw RecognitionTimeout(config_.timeoutMs);
+                default:
+                    throw std::runtime_error("Recognition failed");
+            }
+            for (auto &&format : config_.formats) result.outputs.emplace_back(format, renderOutput(api, format));
+        } catch (const std::exception &e) {
+            result.failed = true;
+            result.error = e.what();
+            result.outputs.clear();
+        }
+        api.Clear();
+        return result;
+    }
+
+    std::shared_ptr<PysseractPool> pool_;
+    const BatchConfig config_;
+    std::vector<BatchItem> items_;
+    std::shared_ptr<std::atomic<bool>> busy_;
+    std::atomic<bool> busyReleased_{false};
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::vector<std::deque<size_t>> queues_;
+    std::deque<PageResult> done_;
+    size_t inFlight_ = 0;
+    size_t consumed_ = 0;
+    size_t next_ = 0;
+    bool closed_ = false;
+    std::vector<std::thread> threads_;
+};
+
+struct OcrBatch {
+    std::shared_ptr<PysseractPool> pool;
+    BatchConfig config;
+    std::shared_ptr<std::atomic<bool>> busy = std::make_shared<std::atomic<bool>>(false);
+};
+
+BatchItem toBatchItem(py::handle obj) {
+    BatchItem item;
+    if (py::isinstance<py::str>(obj) || py::hasattr(obj, "__fspath__")) {
+        item.kind = BatchItem::PATH;
+        item.path = py::module::import("os").attr("fspath")(obj).cast<std::string>();
+    } else if (PyObject_CheckBuffer(obj.ptr())) {
+        item.buffer.reset(new py::buffer_info(py::reinterpret_borrow<py::buffer>(obj).request()));
+        if (item.buffer->ndim == 1 && item.buffer->itemsize == 1) {
+            checkEncodedBytes(*item.buffer);
+            item.kind = BatchItem::ENCODED;
+        } else {
+            item.kind = BatchItem::PIXELS;
+            item.pixels = pixelBuffer(*item.buffer);
+        }
+    } else {
+        throw py::type_error("OcrBatch items must be image paths, encoded image bytes or uint8 pixel arrays");
+    }
+    return item;
+}
+
+}  // namespace
+
+void bindBatch(py::module &m) {
+    py::class_<BatchRun>(m, "OcrBatchRun", R"pbdoc(
+        Iterator over the results of OcrBatch.run. Each result is a dict with the page's position in the input
+        ("index"), the error message if the page failed ("error", otherwise None) and one entry per requested
+        output format. Call close() (or leave a `with` block) to abandon the remaining pages early.
+    )pbdoc")
+        .def("__iter__", [](BatchRun &run) -> BatchRun & { return run; }, py::return_value_policy::reference_internal)
+        .def("__next__",
+             [](BatchRun &run) {
+                 PageResult result;
+                 bool more;
+                 {
+                     py::gil_scoped_release release;
+                     more = run.next(result);
+                 }
+                 if (!more) throw py::stop_iteration();
+                 py::dict page;
+                 page["index"] = result.index;
+                 page["error"] = result.failed ? py::object(py::str(result.error)) : py::object(py::none());
+                 for (auto &&output : result.outputs) page[py::str(output.first)] = py::str(output.second);
+                 return page;
+             })
+        .def("close", &BatchRun::close, "Stop the run and discard any results that have not been consumed yet.")
+        .def("__enter__", [](BatchRun &run) -> BatchRun & { return run; }, py::return_value_policy::reference_internal,
+             "for use in `with` statement")
+        .def("__exit__",
+             [](BatchRun &run, py::object exc_type, py::object exc_value, py::object traceback) { run.close(); },
+             "for `with` statement; stops the run");
+
+    py::class_<OcrBatch>(m, "OcrBatch", R"pbdoc(
+        Native multi-threaded batch OCR. A fixed set of engines is initialised once (see PysseractPool) and each
+        run spreads its pages over one worker thread per engine with a work-stealing queue, without holding the
+        GIL. Pages can be image paths, encoded image bytes or decoded uint8 pixel arrays as accepted by
+        SetImageFromArray.
+
+        .. code-block:: python
+
+            batch = pysseract.OcrBatch(threads=4, formats=["text", "tsv"])
+            for page in batch.run(paths):
+                if page["error"] is None:
+                    print(page["index"], page["text"])
+
+        `formats` can hold "text", "tsv", "hocr" and "alto" (Tesseract 4.1+). Results come back in completion order
+        unless `ordered` is set. `queueDepth` (default twice the thread count) bounds how many pages may be
+        recognised ahead of the consumer. `pageSegMode`, `ppi` and `variables` are applied to every page, and
+        `timeoutMs`, if positive, is the deadline for recognising each page (see Pysseract.Recognize). A failing
+        or timed-out page is reported through its "error" entry and does not stop the batch. Only one run may be
+        active per OcrBatch at a time. With `collectStats`, GetStats() returns the per-stage timings and counters of
+        all workers added up, in the format of Pysseract.GetStats.
+    )pbdoc")
+        .def(py::init([](const char *datapath, const char *language, OcrEngineMode mode, size_t threads,
+                         size_t queueDepth, bool ordered, std::vector<std::string> formats, py::object pageSegMode,
+                         int ppi, int timeoutMs, std::unordered_map<std::string, std::string> variables,
+                         bool collectStats) {
+                 if (threads == 0) throw std::invalid_argument("OcrBatch needs at least one thread");
+                 if (formats.empty()) throw std::invalid_argument("OcrBatch needs at least one output format");
+                 for (auto &&format : formats) checkOutputFormat(format);
+                 std::unique_ptr<OcrBatch> batch(new OcrBatch);
+                 batch->config.threads = threads;
+                 batch->config.queueDepth = queueDepth > 0 ? queueDepth : 2 * threads;
+                 batch->config.ordered = ordered;
+                 batch->config.formats = std::move(formats);
+                 batch->config.pageSegMode = pageSegMode.is_none() ? -1 : pageSegMode.cast<PageSegMode>();
+                 batch->config.ppi = ppi;
+                 batch->config.timeoutMs = timeoutMs;
+                 batch->config.variables = std::move(variables);
+                 {
+                     py::gil_scoped_release release;
+                     batch->pool = std::make_shared<PysseractPool>(datapath, language, mode, threads);
+                     batch->pool->setCollectStats(collectStats);
+                 }
+                 return batch;
+             }),
+             py::arg("datapath") = nullptr, py::arg("language") = nullptr,
+             py::arg("engineMode") = OcrEngineMode::OEM_DEFAULT,
+             py::arg("threads") = std::max(1u, std::thread::hardware_concurrency()), py::arg("queueDepth") = 0,
+             py::arg("ordered") = false, py::arg("formats") = std::vector<std::string>{"text"},
+             py::arg("pageSegMode") = py::none(), py::arg("ppi") = 0, py::arg("timeoutMs") = 0,
+             py::arg("variables") = std::unordered_map<std::string, std::string>{}, py::arg("collectStats") = false)
+        .def("run",
+             [](OcrBatch &batch, py::iterable pages) {
+                 std::vector<BatchItem> items;
+                 for (auto &&page : pages) items.push_back(toBatchItem(page));
+                 if (batch.busy->exchange(true)) {
+                     throw std::runtime_error("This OcrBatch is already running; exhaust or close the previous run");
+                 }
+                 return std::unique_ptr<BatchRun>(new BatchRun(batch.pool, batch.config, std::move(items), batch.busy));
+             },
+             py::arg("pages"), py::keep_alive<0, 1>(),
+             "Start recognising `pages` in the background and return an OcrBatchRun iterating over the results.")
+        .def_property_readonly("threads", [](const OcrBatch &batch) { return batch.config.threads; },
+                               "Read-only: number of worker threads and engines")
+        .def("GetStats", [](const OcrBatch &batch) { return statsToDict(batch.pool->stats()); },
+             "Return the stats of all workers added up, in the format of Pysseract.GetStats.")
+        .def("ResetStats", [](OcrBatch &batch) { batch.pool->resetStats(); }, "Zero the stats of every worker.");
+}
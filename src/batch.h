@@ -0,0 +1,8 @@
+#pragma once
+
+#include <pybind11/pybind11.h>
+
+/**
+ * Register OcrBatch, the native multi-threaded batch OCR engine, and its result iterator.
+ **/
+void bindBatch(pybind11::module &m);
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <leptonica/allheaders.h>
+#include <pybind11/pybind11.h>
+#include <memory>
+#include <stdexcept>
+
+struct PixDeleter {
+    void operator()(Pix *pix) const { pixDestroy(&pix); }
+};
+
+struct LeptDeleter {
+    void operator()(void *ptr) const { lept_free(ptr); }
+};
+
+/**
+ * Owning handles for a Pix and for buffers Leptonica allocates on our behalf, e.g. the output of pixWriteMem.
+ **/
+using PixPtr = std::unique_ptr<Pix, PixDeleter>;
+using LeptBuffer = std::unique_ptr<l_uint8, LeptDeleter>;
+
+/**
+ * Validate a buffer of encoded image bytes, which Leptonica decodes in place as one contiguous block.
+ **/
+inline void checkEncodedBytes(const pybind11::buffer_info &info) {
+    if (info.ndim != 1 || info.itemsize != 1 || (info.size > 1 && info.strides[0] != 1)) {
+        throw std::invalid_argument("Encoded image bytes must be a contiguous bytes-like object");
+    }
+}
+
+/**
+ * Decoded uint8 pixels borrowed from a buffer-protocol object, laid out the way TessBaseAPI::SetImage expects them.
+ * Only valid while the buffer_info it was made from is alive.
+ **/
+struct PixelBuffer {
+    const unsigned char *data;
+    int width;
+    int height;
+    int channels;
+    int bytesPerLine;
+};
+
+/**
+ * Validate an image array of shape (height, width) or (height, width, channels) with 1, 3 or 4 uint8 channels.
+ **/
+inline PixelBuffer pixelBuffer(const pybind11::buffer_info &info) {
+    if (info.itemsize != 1) {
+        throw std::invalid_argument("Image arrays must hold uint8 pixels");
+    }
+    if (info.ndim != 2 && info.ndim != 3) {
+        throw std::invalid_argument("Image arrays must have shape (height, width) or (height, width, channels)");
+    }
+    PixelBuffer buf;
+    buf.data = static_cast<const unsigned char *>(info.ptr);
+    buf.height = static_cast<int>(info.shape[0]);
+    buf.width = static_cast<int>(info.shape[1]);
+    buf.channels = info.ndim == 3 ? static_cast<int>(info.shape[2]) : 1;
+    buf.bytesPerLine = static_cast<int>(info.strides[0]);
+    if (buf.channels != 1 && buf.channels != 3 && buf.channels != 4) {
+        throw std::invalid_argument("Image arrays must have 1 (grayscale), 3 (RGB) or 4 (RGBA) channels");
+    }
+    // rows may be padded, but pixels within a row must be packed
+    if ((info.ndim == 3 && info.strides[2] != 1) || info.strides[1] != buf.channels ||
+        info.strides[0] < static_cast<pybind11::ssize_t>(buf.width) * buf.channels) {
+        throw std::invalid_argument("Image arrays must be C-contiguous");
+    }
+    return buf;
+}
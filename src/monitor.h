@@ -0,0 +1,84 @@
+#pragma once
+
+#include <tesseract/ocrclass.h>
+#include <atomic>
+#include <functional>
+#include <stdexcept>
+#include <string>
+
+#include "pysseract.h"
+
+/**
+ * Thrown when a page is not recognised before its deadline; surfaces in Python as pysseract.RecognitionTimeout.
+ **/
+class RecognitionTimeout : public std::runtime_error {
+   public:
+    explicit RecognitionTimeout(int timeoutMs)
+        : std::runtime_error("Recognition did not finish within " + std::to_string(timeoutMs) + " ms") {}
+};
+
+/**
+ * Tesseract's ETEXT_DESC progress monitor wired up so that recognition can be cancelled from another thread, can
+ * report its progress and, optionally, stops at a deadline. Tesseract polls the monitor between words.
+ **/
+class RecognitionMonitor {
+   public:
+    enum Outcome { DONE, CANCELLED, TIMED_OUT, FAILED };
+
+    explicit RecognitionMonitor(int timeoutMs = 0) : timeoutMs_(timeoutMs) {
+        desc_.cancel = &RecognitionMonitor::isCancelled;
+        desc_.cancel_this = this;
+        if (timeoutMs > 0) desc_.set_deadline_msecs(timeoutMs);
+    }
+    RecognitionMonitor(const RecognitionMonitor &) = delete;
+    RecognitionMonitor &operator=(const RecognitionMonitor &) = delete;
+
+    /**
+     * Ask a running Recognize to stop at the next word. Safe to call from any thread.
+     **/
+    void Cancel() { cancelled_ = true; }
+
+    /**
+     * Have `progress` called with the percentage done (0-100) whenever it changes. It runs on the recognising
+     * thread.
+     **/
+    void SetProgress(std::function<void(int)> progress) {
+        progress_ = std::move(progress);
+        desc_.progress_callback2 = &RecognitionMonitor::onProgress;
+    }
+
+    int TimeoutMs() const { return timeoutMs_; }
+
+    /**
+     * Recognise the current image of `api` under this monitor. A page that did not finish is discarded rather than
+     * left half-recognised, so the text getters never return partial results. Results that are still valid for the
+     * current image are reused as they are.
+     **/
+    Outcome Recognize(Pysseract &api) {
+        if (api.HasResults() || api.RecognizePage(&desc_) == 0) {
+            if (progress_ && lastProgress_ != 100) progress_(100);
+            return DONE;
+        }
+        Outcome outcome = cancelled_ ? CANCELLED : desc_.deadline_exceeded() ? TIMED_OUT : FAILED;
+        api.DiscardResults();
+        return outcome;
+    }
+
+   private:
+    static bool isCancelled(void *self, int words) { return static_cast<RecognitionMonitor *>(self)->cancelled_; }
+
+    static bool onProgress(ETEXT_DESC *desc, int left, int right, int top, int bottom) {
+        auto *self = static_cast<RecognitionMonitor *>(desc->cancel_this);
+        if (desc->progress != self->lastProgress_) {
+            self->lastProgress_ = desc->progress;
+            self->progress_(desc->progress);
+        }
+        return true;
+    }
+
+    ETEXT_DESC desc_;
+    int timeoutMs_;
+    std::atomic<bool> cancelled_{false};
+    std::function<void(int)> progress_;
+    int lastProgress_ = -1;
+};
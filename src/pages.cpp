@@ -0,0 +1,166 @@
+#include "pages.h"
+
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "image.h"
+#include "monitor.h"
+#include "stats.h"
+
+namespace py = pybind11;
+
+PageStream::PageStream(Pysseract &api, py::handle source, std::vector<std::string> formats, int ppi, int timeoutMs)
+    : api_(api), formats_(std::move(formats)), ppi_(ppi), timeoutMs_(timeoutMs) {
+    if (py::isinstance<py::str>(source) || py::hasattr(source, "__fspath__")) {
+        std::string path = py::module::import("os").attr("fspath")(source).cast<std::string>();
+#ifdef _WIN32
+        std::ifstream file(path, std::ios::binary);
+        if (!file) throw std::runtime_error("Failed to open '" + path + "'");
+        contents_.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        data_ = reinterpret_cast<const l_uint8 *>(contents_.data());
+        size_ = contents_.size();
+#else
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("Failed to open '" + path + "'");
+        struct stat info;
+        if (fstat(fd, &info) == 0 && info.st_size > 0) {
+            size_ = static_cast<size_t>(info.st_size);
+            mapping_ = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+        ::close(fd);
+        if (mapping_ == nullptr || mapping_ == MAP_FAILED) {
+            mapping_ = nullptr;
+            throw std::runtime_error("Failed to map '" + path + "'");
+        }
+        // pages are read front to back, so the kernel can read ahead and drop what has been recognised
+        madvise(mapping_, size_, MADV_SEQUENTIAL);
+        data_ = static_cast<const l_uint8 *>(mapping_);
+#endif
+    } else if (PyObject_CheckBuffer(source.ptr())) {
+        buffer_.reset(new py::buffer_info(py::reinterpret_borrow<py::buffer>(source).request()));
+        if (buffer_->ndim != 1 || buffer_->itemsize != 1) {
+            throw std::invalid_argument("RecognizePages expects encoded image bytes, not decoded pixels");
+        }
+        checkEncodedBytes(*buffer_);
+        data_ = static_cast<const l_uint8 *>(buffer_->ptr);
+        size_ = static_cast<size_t>(buffer_->size);
+    } else {
+        throw py::type_error("RecognizePages expects an image path or encoded image bytes");
+    }
+
+    l_int32 format = IFF_UNKNOWN;
+    if (size_ >= 12) findFileFormatBuffer(data_, &format);
+    tiff_ = L_FORMAT_IS_TIFF(format);
+    api_.Stats().add(Counter::BYTES_DECODED, size_);
+    pending_ = std::async(std::launch::async, &PageStream::decode, this);
+}
+
+PageStream::~PageStream() { close(); }
+
+bool PageStream::next(PageResult &out) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!pending_.valid()) return false;
+    DecodedPage page = pending_.get();
+    if (page.pix != nullptr && !page.last) pending_ = std::async(std::launch::async, &PageStream::decode, this);
+
+    out = PageResult();
+    out.index = index_++;
+    if (page.pix == nullptr) {
+        // the position of the following page is unknown once a page cannot be read, so the stream ends here
+        out.failed = true;
+        out.error = "Failed to decode the image";
+        return true;
+    }
+    try {
+        api_.SetImage(page.pix);
+        pixDestroy(&page.pix);
+        if (ppi_ > 0) api_.SetSourceResolution(ppi_);
+        RecognitionMonitor monitor(timeoutMs_);
+        switch (monitor.Recognize(api_)) {
+            case RecognitionMonitor::DONE:
+                break;
+            case RecognitionMonitor::TIMED_OUT:
+                throw RecognitionTimeout(timeoutMs_);
+            default:
+                throw std::runtime_error("Recognition failed");
+        }
+        for (auto &&format : formats_) out.outputs.emplace_back(format, renderOutput(api_, format));
+    } catch (const std::exception &e) {
+        out.failed = true;
+        out.error = e.what();
+        out.outputs.clear();
+    }
+    return true;
+}
+
+void PageStream::close() {
+    {
+        py::gil_scoped_release release;
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (pending_.valid()) {
+            DecodedPage page = pending_.get();
+            pixDestroy(&page.pix);
+        }
+    }
+#ifndef _WIN32
+    if (mapping_ != nullptr) munmap(mapping_, size_);
+    mapping_ = nullptr;
+#endif
+    contents_.clear();
+    buffer_.reset();
+    data_ = nullptr;
+}
+
+DecodedPage PageStream::decode() {
+    StageTimer timer(api_.Stats(), Stage::DECODE);
+    DecodedPage page;
+    if (tiff_) {
+        page.pix = pixReadMemFromMultipageTiff(data_, size_, &offset_);
+        page.last = offset_ == 0;
+    } else {
+        page.pix = pixReadMem(data_, size_);
+    }
+    return page;
+}
+
+void bindPages(py::module &m) {
+    py::class_<PageStream>(m, "PageStream", R"pbdoc(
+        Iterator returned by Pysseract.RecognizePages. Each result is a dict with the 0-based page number ("index"),
+        the error message if the page failed ("error", otherwise None) and one entry per requested output format.
+        Call close() (or leave a `with` block) to stop early and release the file.
+    )pbdoc")
+        .def("__iter__", [](PageStream &stream) -> PageStream & { return stream; },
+             py::return_value_policy::reference_internal)
+        .def("__next__",
+             [](PageStream &stream) {
+                 PageResult result;
+                 bool more;
+                 {
+                     py::gil_scoped_release release;
+                     more = stream.next(result);
+                 }
+                 if (!more) throw py::stop_iteration();
+                 py::dict page;
+                 page["index"] = result.index;
+                 page["error"] = result.failed ? py::object(py::str(result.error)) : py::object(py::none());
+                 for (auto &&output : result.outputs) page[py::str(output.first)] = py::str(output.second);
+                 return page;
+             })
+        .def("close", &PageStream::close, "Stop reading pages and release the source.")
+        .def("__enter__", [](PageStream &stream) -> PageStream & { return stream; },
+             py::return_value_policy::reference_internal, "for use in `with` statement")
+        .def("__exit__",
+             [](PageStream &stream, py::object exc_type, py::object exc_value, py::object traceback) {
+                 stream.close();
+             },
+             "for `with` statement; stops the stream");
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <leptonica/allheaders.h>
+#include <pybind11/pybind11.h>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "pysseract.h"
+#include "render.h"
+
+/**
+ * A page decoded ahead of its recognition; `pix` is null if it could not be decoded.
+ **/
+struct DecodedPage {
+    Pix *pix = nullptr;
+    bool last = true;
+};
+
+/**
+ * Recognises the pages of an image file or buffer one after the other with a single engine. Multi-page TIFFs are
+ * read straight from a memory-mapped file (or the caller's buffer) one page at a time, and page N+1 is decoded on
+ * a background thread while page N is recognised, so only two decoded pages exist at any moment no matter how long
+ * the document is. Any other image format is a single page.
+ **/
+class PageStream {
+   public:
+    PageStream(Pysseract &api, pybind11::handle source, std::vector<std::string> formats, int ppi, int timeoutMs);
+    ~PageStream();
+    PageStream(const PageStream &) = delete;
+    PageStream &operator=(const PageStream &) = delete;
+
+    /**
+     * Recognise the next page. Must be called without holding the GIL. Returns false at the end of the document or
+     * once the stream was closed.
+     **/
+    bool next(PageResult &out);
+
+    /**
+     * Stop decoding, drop the page decoded ahead and unmap the source. Must be called with the GIL held.
+     **/
+    void close();
+
+   private:
+    DecodedPage decode();
+
+    Pysseract &api_;
+    const std::vector<std::string> formats_;
+    const int ppi_;
+    const int timeoutMs_;
+
+    std::unique_ptr<pybind11::buffer_info> buffer_;  // when reading from a Python buffer
+    void *mapping_ = nullptr;                         // when reading from a file
+    std::string contents_;                            // file contents where mmap is not available
+    const l_uint8 *data_ = nullptr;
+    size_t size_ = 0;
+    bool tiff_ = false;
+    size_t offset_ = 0;  // of the next TIFF directory, only touched by decode()
+
+    std::mutex mutex_;
+    std::future<DecodedPage> pending_;
+    size_t index_ = 0;
+};
+
+void bindPages(pybind11::module &m);
@@ -0,0 +1,154 @@
+#include "pool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+namespace py = pybind11;
+using tesseract::OcrEngineMode;
+
+PysseractPool::PysseractPool(const char *datapath, const char *language, OcrEngineMode mode, size_t size) {
+    if (size == 0) throw std::invalid_argument("A PysseractPool needs at least one engine");
+    const std::string lang = language != nullptr && *language ? language : "eng";
+
+    // every engine initialises from disk, so they all resolve the same data path for configs and user words
+    while (engines_.size() < size) {
+        std::unique_ptr<Pysseract> api(new Pysseract);
+        if (api->Init(datapath, lang.c_str(), mode) != 0) {
+            throw std::runtime_error("Failed to initialise Tesseract with language '" + lang + "'");
+        }
+        engines_.push_back(std::move(api));
+    }
+    for (auto &&api : engines_) idle_.push_back(api.get());
+}
+
+Pysseract *PysseractPool::acquire(double timeout) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto ready = [this] { return !idle_.empty(); };
+    if (timeout < 0) {
+        cv_.wait(lock, ready);
+    } else if (!cv_.wait_for(lock, std::chrono::duration<double>(timeout), ready)) {
+        return nullptr;
+    }
+    Pysseract *api = idle_.back();
+    idle_.pop_back();
+    return api;
+}
+
+void PysseractPool::release(Pysseract *api) {
+    api->Clear();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        idle_.push_back(api);
+    }
+    cv_.notify_one();
+}
+
+size_t PysseractPool::available() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return idle_.size();
+}
+
+void PysseractPool::setCollectStats(bool enabled) {
+    for (auto &&api : engines_) api->Stats().setEnabled(enabled);
+}
+
+StatsSnapshot PysseractPool::stats() const {
+    StatsSnapshot total;
+    for (auto &&api : engines_) total += api->Stats().snapshot();
+    return total;
+}
+
+void PysseractPool::resetStats() {
+    for (auto &&api : engines_) api->Stats().reset();
+}
+
+/**
+ * An engine checked out of a pool; it goes back to the pool on __exit__, release() or garbage collection, whichever
+ * comes first.
+ **/
+struct PysseractLease {
+    std::shared_ptr<PysseractPool> pool;
+    Pysseract *api;
+
+    PysseractLease(std::shared_ptr<PysseractPool> pool, Pysseract *api) : pool(std::move(pool)), api(api) {}
+    ~PysseractLease() { release(); }
+
+    void release() {
+        if (api != nullptr) pool->release(api);
+        api = nullptr;
+    }
+};
+
+void bindPool(py::module &m) {
+    py::class_<PysseractLease>(m, "PysseractLease", R"pbdoc(
+        A Pysseract engine checked out of a PysseractPool. Use it in a `with` block, which yields the engine and
+        returns it to the pool (after a Clear) when the block exits.
+    )pbdoc")
+        .def("__enter__",
+             [](PysseractLease &lease) {
+                 if (lease.api == nullptr) throw std::runtime_error("This lease has already been released.");
+                 return lease.api;
+             },
+             py::return_value_policy::reference_internal, "for use in `with` statement")
+        .def("__exit__",
+             [](PysseractLease &lease, py::object exc_type, py::object exc_value, py::object traceback) {
+                 lease.release();
+             },
+             "for `with` statement; returns the engine to the pool")
+        .def("release", &PysseractLease::release,
+             "Return the engine to the pool. The engine must not be used through this lease afterwards.");
+
+    py::class_<PysseractPool, std::shared_ptr<PysseractPool>>(m, "PysseractPool", R"pbdoc(
+        A pool of pre-initialised Pysseract engines for worker threads. Creating a Pysseract parses the traineddata,
+        which is slow and memory hungry, so long-running services should create a pool once and check engines out
+        per job instead:
+
+        .. code-block:: python
+
+            pool = pysseract.PysseractPool(size=4)
+
+            def ocr(path):
+                with pool.checkout() as t:
+                    t.SetImageFromPath(path)
+                    return t.utf8Text
+
+        Tesseract keeps one copy of the parsed model per engine, so memory grows with `size`. Engines are reset
+        with Clear (not End) when they are returned. Do not call End or use an engine in its own `with` block, since that shuts
+        the engine down for every later user of the pool.
+
+        With `collectStats`, every engine collects the timings and counters described in Pysseract.GetStats, and
+        GetStats() returns them summed over the whole pool.
+    )pbdoc")
+        .def(py::init([](const char *datapath, const char *language, OcrEngineMode mode, size_t size,
+                         bool collectStats) {
+                 py::gil_scoped_release release;
+                 auto pool = std::make_shared<PysseractPool>(datapath, language, mode, size);
+                 pool->setCollectStats(collectStats);
+                 return pool;
+             }),
+             py::arg("datapath") = nullptr, py::arg("language") = nullptr,
+             py::arg("engineMode") = OcrEngineMode::OEM_DEFAULT,
+             py::arg("size") = std::max(1u, std::thread::hardware_concurrency()), py::arg("collectStats") = false)
+        .def("checkout",
+             [](std::shared_ptr<PysseractPool> pool, double timeout) {
+                 Pysseract *api;
+                 {
+                     py::gil_scoped_release release;
+                     api = pool->acquire(timeout);
+                 }
+                 if (api == nullptr) throw std::runtime_error("Timed out waiting for a free Pysseract engine");
+                 return std::unique_ptr<PysseractLease>(new PysseractLease(pool, api));
+             },
+             py::arg("timeout") = -1.0, R"pbdoc(
+        Check out an idle engine, blocking until one is free or `timeout` seconds have passed (forever if
+        negative). Returns a PysseractLease to be used in a `with` block.
+    )pbdoc")
+        .def_property_readonly("size", &PysseractPool::size, "Read-only: number of engines in the pool")
+        .def_property_readonly("available", &PysseractPool::available,
+                               "Read-only: number of engines currently idle")
+        .def("GetStats", [](const PysseractPool &pool) { return statsToDict(pool.stats()); },
+             "Return the stats of all engines added up, in the format of Pysseract.GetStats.")
+        .def("ResetStats", &PysseractPool::resetStats, "Zero the stats of every engine.");
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <pybind11/pybind11.h>
+#include <tesseract/baseapi.h>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "pysseract.h"
+#include "stats.h"
+
+/**
+ * A fixed set of initialised Pysseract engines that are handed out one at a time.
+ *
+ * Every engine is initialised up front, so checking one out never pays for loading the traineddata. Engines are
+ * reset with Clear() when they come back, which keeps the loaded model around for the next job.
+ **/
+class PysseractPool {
+   public:
+    PysseractPool(const char *datapath, const char *language, tesseract::OcrEngineMode mode, size_t size);
+
+    /**
+     * Take an idle engine, waiting up to `timeout` seconds (forever if negative). Returns nullptr on timeout.
+     * Must be called without holding the GIL.
+     **/
+    Pysseract *acquire(double timeout = -1);
+
+    /**
+     * Clear an engine obtained from acquire() and make it available again.
+     **/
+    void release(Pysseract *api);
+
+    size_t size() const { return engines_.size(); }
+    size_t available();
+
+    /**
+     * Turn stats collection on or off for every engine, and sum up or reset their stats. Engines may be checked out
+     * at the time.
+     **/
+    void setCollectStats(bool enabled);
+    StatsSnapshot stats() const;
+    void resetStats();
+
+   private:
+    std::vector<std::unique_ptr<Pysseract>> engines_;
+    std::vector<Pysseract *> idle_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+};
+
+void bindPool(pybind11::module &m);
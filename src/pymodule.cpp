@@ -1,9 +1,26 @@
 #include <leptonica/allheaders.h>
+#include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 #include <tesseract/baseapi.h>
 #include <tesseract/genericvector.h>
+#include <cstring>
+#include <exception>
+#include <memory>
 #include <sstream>
+#include <string>
+#include <vector>
+
+#include "background.h"
+#include "batch.h"
+#include "image.h"
+#include "monitor.h"
+#include "pages.h"
+#include "pool.h"
+#include "pysseract.h"
+#include "regions.h"
+#include "render.h"
+#include "stats.h"
 
 namespace py = pybind11;
 using tesseract::OcrEngineMode;
@@ -12,30 +29,244 @@ using tesseract::PageSegMode;
 using tesseract::ResultIterator;
 using tesseract::TessBaseAPI;
 
+/**
+ * Tesseract only resolves its default data path during a full Init, which loads a whole model. Do that once per
+ * process and remember the answers instead of paying for it on every availableLanguages/defaultDataPath call.
+ **/
+struct DefaultEnvironment {
+    std::string datapath;
+    std::vector<std::string> languages;
+};
+
+static const DefaultEnvironment &defaultEnvironment() {
+    static const DefaultEnvironment env = [] {
+        DefaultEnvironment env;
+        TessBaseAPI api;
+        api.Init(nullptr, nullptr);
+        env.datapath = api.GetDatapath();
+        GenericVector<STRING> glangs;
+        api.GetAvailableLanguagesAsVector(&glangs);
+        for (int i = 0; i < glangs.size(); i++) {
+            env.languages.push_back(glangs[i].c_str());
+        }
+        api.End();
+        return env;
+    }();
+    return env;
+}
+
+/**
+ * Hand a string that Tesseract allocated with new[] to Python and free it. Tesseract returns null when there is no
+ * image or recognition failed, which becomes None.
+ **/
+static py::object takeText(char *text) {
+    std::unique_ptr<char[]> owned(text);
+    if (!owned) return py::none();
+    return py::str(owned.get());
+}
+
+/**
+ * Run one of the TessBaseAPI text getters with the GIL released and take ownership of its result as in takeText.
+ * For getters that render recognition results (`rendersResults`), the page is recognised first when stats are
+ * collected, so that the getter itself only counts as rendering. Other getters, such as GetOsdText, do their own
+ * analysis and are not timed as a stage.
+ **/
+template <typename Getter>
+static py::object takeText(Pysseract &api, Getter getter, bool rendersResults = true) {
+    char *text;
+    {
+        py::gil_scoped_release release;
+        if (rendersResults) {
+            if (api.Stats().enabled()) api.EnsureRecognized();
+            StageTimer timer(api.Stats(), Stage::RENDER);
+            text = getter(api);
+        } else {
+            text = getter(api);
+        }
+        if (text != nullptr) api.Stats().add(Counter::BYTES_ENCODED, strlen(text));
+    }
+    return takeText(text);
+}
+
+/**
+ * Encode `pix` in the format Leptonica picks for it with the GIL released and copy the encoded buffer straight into
+ * a bytes object.
+ **/
+static py::bytes encodePix(Pix *pix, EngineStats &stats, const char *error) {
+    l_uint8 *data = nullptr;
+    size_t size = 0;
+    {
+        py::gil_scoped_release release;
+        if (pix != nullptr) pixWriteMem(&data, &size, pix, pixChooseOutputFormat(pix));
+    }
+    LeptBuffer encoded(data);
+    if (!encoded) throw std::runtime_error(error);
+    stats.add(Counter::BYTES_ENCODED, size);
+    return py::bytes(reinterpret_cast<const char *>(encoded.get()), size);
+}
+
+/**
+ * Crop and/or scale `pix` as requested. Ownership of `pix` is taken and the returned Pix must be destroyed by the
+ * caller.
+ **/
+static Pix *cropAndScale(Pix *pix, const Box *crop, float scale) {
+    if (crop != nullptr) {
+        Box box = *crop;
+        Pix *clipped = pixClipRectangle(pix, &box, nullptr);
+        pixDestroy(&pix);
+        if (clipped == nullptr) throw std::invalid_argument("The crop box does not intersect the image");
+        pix = clipped;
+    }
+    if (scale != 1.0f) {
+        if (scale <= 0.0f) {
+            pixDestroy(&pix);
+            throw std::invalid_argument("scale must be positive");
+        }
+        Pix *scaled = pixScale(pix, scale, scale);
+        pixDestroy(&pix);
+        if (scaled == nullptr) throw std::runtime_error("Error scaling the image");
+        pix = scaled;
+    }
+    return pix;
+}
+
+/**
+ * Expose a Pix as a uint8 NumPy array of shape (height, width) or (height, width, channels), taking ownership of
+ * `pix`. 32bpp images are returned as a read-only view over the Pix data; everything else is unpacked into a fresh
+ * array, with 1bpp images mapped to 0 (black) and 255 (white).
+ **/
+static py::array pixToArray(Pix *pix) {
+    if (pixGetColormap(pix) != nullptr) {
+        Pix *decoded = pixRemoveColormap(pix, REMOVE_CMAP_BASED_ON_SRC);
+        pixDestroy(&pix);
+        pix = decoded;
+    }
+    if (pix != nullptr && pixGetDepth(pix) != 1 && pixGetDepth(pix) != 8 && pixGetDepth(pix) != 32) {
+        Pix *converted = pixConvertTo8(pix, 0);
+        pixDestroy(&pix);
+        pix = converted;
+    }
+    if (pix == nullptr) throw std::runtime_error("Error converting the image to an array");
+
+    const py::ssize_t width = pixGetWidth(pix), height = pixGetHeight(pix);
+    const py::ssize_t wpl = pixGetWpl(pix);
+    l_uint32 *data = pixGetData(pix);
+    // frees the Pix once the last array referring to it is gone
+    py::capsule owner(pix, [](void *p) {
+        Pix *pix = static_cast<Pix *>(p);
+        pixDestroy(&pix);
+    });
+
+    if (pixGetDepth(pix) == 32) {
+        // each pixel is one native word 0xRRGGBBAA, so the channels can be addressed in place
+        const py::ssize_t channels = pixGetSpp(pix) == 4 ? 4 : 3;
+#ifdef L_BIG_ENDIAN
+        auto *first = reinterpret_cast<uint8_t *>(data);
+        const py::ssize_t step = 1;
+#else
+        auto *first = reinterpret_cast<uint8_t *>(data) + 3;
+        const py::ssize_t step = -1;
+#endif
+        py::array_t<uint8_t> arr({height, width, channels}, {wpl * 4, py::ssize_t(4), step}, first, owner);
+        arr.attr("flags").attr("writeable") = false;
+        return arr;
+    }
+
+    py::array_t<uint8_t> arr({height, width});
+    uint8_t *out = arr.mutable_data();
+    const bool binary = pixGetDepth(pix) == 1;
+    {
+        py::gil_scoped_release release;
+        for (py::ssize_t y = 0; y < height; y++) {
+            const l_uint32 *line = data + y * wpl;
+            uint8_t *row = out + y * width;
+            if (binary) {
+                for (py::ssize_t x = 0; x < width; x++) row[x] = GET_DATA_BIT(line, x) ? 0 : 255;
+            } else {
+                for (py::ssize_t x = 0; x < width; x++) row[x] = GET_DATA_BYTE(line, x);
+            }
+        }
+    }
+    return arr;
+}
+
+/**
+ * Hand a vector over to NumPy without copying; the array owns the vector's storage from here on.
+ **/
+template <typename T>
+static py::array_t<T> vectorToArray(std::vector<T> &&vec) {
+    auto *owned = new std::vector<T>(std::move(vec));
+    py::capsule owner(owned, [](void *p) { delete static_cast<std::vector<T> *>(p); });
+    return py::array_t<T>(owned->size(), owned->data(), owner);
+}
+
+/**
+ * Struct-of-arrays holder for everything ExtractLevel can return.
+ **/
+struct LevelColumns {
+    std::vector<int32_t> left, top, width, height;
+    std::vector<float> conf;
+    std::string text;
+    std::vector<int64_t> textOffsets{0};
+    std::vector<int32_t> block, para, line;
+};
+
+/**
+ * Walk every element of the given level in the same order as Pysseract.IterAt, filling in only the requested
+ * columns. Unlike Box.top from ResultIterator.BoundingBox, which holds the bottom edge, "top" is the real top edge.
+ **/
+static void extractLevel(ResultIterator &it, PageIteratorLevel level, bool boxes, bool confs, bool texts,
+                         bool parents, LevelColumns &cols) {
+    int32_t block = -1, para = -1, line = -1;
+    while (!it.Empty(level)) {
+        if (boxes) {
+            int left, top, right, bottom;
+            it.BoundingBox(level, &left, &top, &right, &bottom);
+            cols.left.push_back(left);
+            cols.top.push_back(top);
+            cols.width.push_back(right - left);
+            cols.height.push_back(bottom - top);
+        }
+        if (confs) cols.conf.push_back(it.Confidence(level));
+        if (texts) {
+            std::unique_ptr<char[]> text(it.GetUTF8Text(level));
+            if (text) cols.text.append(text.get());
+            cols.textOffsets.push_back(cols.text.size());
+        }
+        if (parents) {
+            if (level > tesseract::RIL_BLOCK) {
+                if (it.IsAtBeginningOf(tesseract::RIL_BLOCK)) block++;
+                cols.block.push_back(block);
+            }
+            if (level > tesseract::RIL_PARA) {
+                if (it.IsAtBeginningOf(tesseract::RIL_PARA)) para++;
+                cols.para.push_back(para);
+            }
+            if (level > tesseract::RIL_TEXTLINE) {
+                if (it.IsAtBeginningOf(tesseract::RIL_TEXTLINE)) line++;
+                cols.line.push_back(line);
+            }
+        }
+        it.Next(level);
+    }
+}
+
 PYBIND11_MODULE(_pysseract, m) {
     m.def("apiVersion", &tesseract::TessBaseAPI::Version, "Tesseract API version as seen in the library");
-    m.def("availableLanguages",
-          []() {
-              tesseract::TessBaseAPI api;
-              api.Init(nullptr, nullptr);
-              GenericVector<STRING> glangs;
-              api.GetAvailableLanguagesAsVector(&glangs);
-              std::vector<std::string> langs(glangs.size());
-              for (int i = 0; i < glangs.size(); i++) {
-                  langs[i] = glangs[i].c_str();
-              }
-              return langs;
-          },
-          "return a list of available languages from TESSDATA_PREFIX");
-    m.def("defaultDataPath",
-          []() {
-              tesseract::TessBaseAPI api;
-              api.Init(nullptr, nullptr);
-              return api.GetDatapath();
-          },
+    m.def("availableLanguages", []() { return defaultEnvironment().languages; },
+          "return a list of available languages from TESSDATA_PREFIX, as found when first queried");
+    m.def("defaultDataPath", []() { return defaultEnvironment().datapath; },
           "return the default location Tesseract expects models to be located in");
 
-    py::class_<TessBaseAPI>(m, "Pysseract", R"pbdoc(
+    py::register_exception<RecognitionTimeout>(m, "RecognitionTimeout", PyExc_TimeoutError);
+
+    py::class_<RecognitionMonitor, std::shared_ptr<RecognitionMonitor>>(m, "RecognitionTask", R"pbdoc(
+        Handle on a recognition running on a native thread, as started by Pysseract.RecognizeAsync and
+        Pysseract.GetTextAsync. Cancelling it makes Tesseract stop at the next word.
+    )pbdoc")
+        .def("cancel", &RecognitionMonitor::Cancel, "Ask the running recognition to stop as soon as possible.");
+
+    py::class_<Pysseract>(m, "Pysseract", R"pbdoc(
         This is the main class for interacting with the Tesseract API. There are several ways to initialise this class. 
         The simplest way with all defaults and assuming that the English model is needed is as follows:
         
@@ -72,28 +303,44 @@ PYBIND11_MODULE(_pysseract, m) {
         You will typically not need both of these things, in which case one can be set as an empty List (or Dict) as the case may be.
         
         For information about working with the results of analysis, please see the documentation for ResultIterator or Pysseract.IterAt
+
+        Image decoding, recognition and text extraction release the GIL, so several Python threads can OCR in
+        parallel as long as each thread owns its own Pysseract instance. A single instance (and any ResultIterator
+        it spawned) is not thread-safe and must not be used from two threads at the same time.
+
+        .. code-block:: python
+
+            from concurrent.futures import ThreadPoolExecutor
+
+            def ocr(path):
+                t = pysseract.Pysseract()
+                t.SetImageFromPath(path)
+                return t.utf8Text
+
+            with ThreadPoolExecutor(4) as pool:
+                texts = list(pool.map(ocr, paths))
     )pbdoc")
         .def(py::init([]() {
-            TessBaseAPI *api = new (TessBaseAPI);
+            Pysseract *api = new Pysseract;
             api->Init(nullptr, nullptr);
-            return std::unique_ptr<TessBaseAPI>(api);
+            return std::unique_ptr<Pysseract>(api);
         }))
         .def(py::init([](const char *datapath, const char *language) {
-                 TessBaseAPI *api = new (TessBaseAPI);
+                 Pysseract *api = new Pysseract;
                  api->Init(datapath, language);
-                 return std::unique_ptr<TessBaseAPI>(api);
+                 return std::unique_ptr<Pysseract>(api);
              }),
              py::arg("datapath"), py::arg("language"))
         .def(py::init([](const char *datapath, const char *language, OcrEngineMode mode) {
-                 TessBaseAPI *api = new (TessBaseAPI);
+                 Pysseract *api = new Pysseract;
                  api->Init(datapath, language, mode);
-                 return std::unique_ptr<TessBaseAPI>(api);
+                 return std::unique_ptr<Pysseract>(api);
              }),
              py::arg("datapath"), py::arg("language"), py::arg("engineMode"))
         .def(py::init([](const char *datapath, const char *language, OcrEngineMode mode,
                          std::vector<std::string> configs, std::unordered_map<std::string, std::string> settings,
                          bool set_only_non_debug_params) {
-                 TessBaseAPI *api = new (TessBaseAPI);
+                 Pysseract *api = new Pysseract;
 
                  char *configs_[configs.size()];
                  for (size_t i = 0; i < configs.size(); i++) {
@@ -109,7 +356,7 @@ PYBIND11_MODULE(_pysseract, m) {
 
                  api->Init(datapath, language, mode, configs_, configs.size(), &vars_vec, &vars_values,
                            set_only_non_debug_params);
-                 return std::unique_ptr<TessBaseAPI>(api);
+                 return std::unique_ptr<Pysseract>(api);
              }),
              py::arg("datapath"), py::arg("language"), py::arg("engineMode"), py::arg("configsList"),
              py::arg("settingDict"), py::arg("setOnlyNonDebugParams"))
@@ -121,101 +368,499 @@ PYBIND11_MODULE(_pysseract, m) {
     )pbdoc")
         .def("End", &TessBaseAPI::End,
              "Close down tesseract and free up all memory, after which the instance should not be reused.")
-        .def("__enter__", [](TessBaseAPI &api) { return &api; }, "for use in `with` statement")
+        .def("__enter__", [](Pysseract &api) { return &api; }, "for use in `with` statement")
         .def("__exit__",
-             [](TessBaseAPI &api, py::object exc_type, py::object exc_value, py::object traceback) { api.End(); },
+             [](Pysseract &api, py::object exc_type, py::object exc_value, py::object traceback) { api.End(); },
              "for `with` statement; after exiting the `with` code block the instance is not reusable.")
         .def_property_readonly("dataPath", &TessBaseAPI::GetDatapath,
                                R"pbdoc(Read-only: Returns the path where Tesseract model objects are stored)pbdoc")
         .def_property(
-            "pageSegMode", &TessBaseAPI::GetPageSegMode, &TessBaseAPI::SetPageSegMode,
+            "pageSegMode", &TessBaseAPI::GetPageSegMode,
+            [](Pysseract &api, PageSegMode mode) {
+                if (mode != api.GetPageSegMode()) api.DiscardResults();
+                api.SetPageSegMode(mode);
+            },
             R"pbdoc(This attribute can be used to get or set the page segmentation mode used by the tesseract model)pbdoc")
-        .def_property_readonly("utf8Text", &TessBaseAPI::GetUTF8Text,
+        .def_property_readonly("recognized", &Pysseract::HasResults, R"pbdoc(
+        Read-only: True when the current image and rectangle have been recognised and the results are still valid.
+        Text getters, GetIterator, ExtractLevel and GetOutputs reuse these results instead of recognising again;
+        SetImage*, SetRectangle, Clear, pageSegMode, SetSourceResolution and SetVariable invalidate them.
+    )pbdoc")
+        .def_property(
+            "collectStats", [](Pysseract &api) { return api.Stats().enabled(); },
+            [](Pysseract &api, bool enabled) { api.Stats().setEnabled(enabled); }, R"pbdoc(
+        Whether to collect per-stage timings and counters for GetStats(). Off by default, which costs next to
+        nothing. While on, recognition runs thresholding, layout analysis and word recognition as separately timed
+        steps.
+    )pbdoc")
+        .def("GetStats", [](Pysseract &api) { return statsToDict(api.Stats().snapshot()); }, R"pbdoc(
+        Return the timings and counters collected since the last ResetStats() while collectStats was on, as a dict:
+
+        - "pages", "words", "symbols": pages recognised and the words and symbols found on them
+        - "bytes_decoded", "bytes_encoded": encoded image bytes read, and text or image bytes produced
+        - "stages": for each of "decode", "threshold", "layout", "recognition" and "render", a dict with the number
+          of times it ran ("count"), "total_ms", "max_ms" and a "histogram" of durations
+        - "histogram_bounds_ms": the exclusive upper bounds of all but the last histogram bucket, which holds
+          everything slower
+    )pbdoc")
+        .def("ResetStats", [](Pysseract &api) { api.Stats().reset(); }, "Zero all timings and counters.")
+        .def_property_readonly("utf8Text",
+                               [](Pysseract &api) {
+                                   return takeText(api, [](Pysseract &api) { return api.GetUTF8Text(); });
+                               },
                                R"pbdoc(Read-only: Return all identified text concatenated into a UTF-8 string)pbdoc")
         .def_property_readonly(
-            "unlvText", &TessBaseAPI::GetUNLVText,
+            "unlvText",
+            [](Pysseract &api) { return takeText(api, [](Pysseract &api) { return api.GetUNLVText(); }); },
             R"pbdoc(Read-only: Return all identified text according to UNLV format Latin-1 with specific reject and suspect codes)pbdoc")
-        .def("GetHOCRText", (char *(TessBaseAPI::*)(int)) & TessBaseAPI::GetHOCRText, py::arg("pagenum"),
+        .def("GetHOCRText",
+             [](Pysseract &api, int pagenum) {
+                 return takeText(api, [pagenum](Pysseract &api) { return api.GetHOCRText(pagenum); });
+             },
+             py::arg("pagenum"),
              "Make an HTML-formatted string with hOCR. 'pagenum' is 0-based, appears as 1-based in results.")
-        .def("GetTSVText", &TessBaseAPI::GetTSVText, py::arg("pagenum"),
+        .def("GetTSVText",
+             [](Pysseract &api, int pagenum) {
+                 return takeText(api, [pagenum](Pysseract &api) { return api.GetTSVText(pagenum); });
+             },
+             py::arg("pagenum"),
              "Make a TSV-formatted string from the internal data structures. 'pagenum' is 0-based, appears as 1-based "
              "in results.")
 #if TESSERACT_VERSION >= (4 << 16 | 1 << 8)
-        .def("GetAltoText", (char *(TessBaseAPI::*)(int)) & TessBaseAPI::GetAltoText, py::arg("pagenum"),
+        .def("GetAltoText",
+             [](Pysseract &api, int pagenum) {
+                 return takeText(api, [pagenum](Pysseract &api) { return api.GetAltoText(pagenum); });
+             },
+             py::arg("pagenum"),
              "Make an ALTO XML string from internal data. 'pagenum' is 0-based, appears as 1-based in results.")
-        .def("GetLSTMBoxText", &TessBaseAPI::GetLSTMBoxText, py::arg("pagenum"),
+        .def("GetLSTMBoxText",
+             [](Pysseract &api, int pagenum) {
+                 return takeText(api, [pagenum](Pysseract &api) { return api.GetLSTMBoxText(pagenum); });
+             },
+             py::arg("pagenum"),
              "Make a box file for LSTM training from the internal data structures. 'pagenum' is 0-based, appears as "
              "1-based in results.")
-        .def("GetWordStrBoxText", &TessBaseAPI::GetWordStrBoxText, py::arg("pagenum"),
+        .def("GetWordStrBoxText",
+             [](Pysseract &api, int pagenum) {
+                 return takeText(api, [pagenum](Pysseract &api) { return api.GetWordStrBoxText(pagenum); });
+             },
+             py::arg("pagenum"),
              "Make a string formatted in the same style as Tesseract training data. 'pagenum' is 0-based, appears as "
              "1-based in results.")
 #endif
-        .def("GetOsdText", &TessBaseAPI::GetOsdText, py::arg("pagenum"),
+        .def("GetOsdText",
+             [](Pysseract &api, int pagenum) {
+                 return takeText(api, [pagenum](Pysseract &api) { return api.GetOsdText(pagenum); }, false);
+             },
+             py::arg("pagenum"),
              "Recognised text is returned as UTF-8. 'pagenum' is 0-based, appears as 1-based in results.")
         .def("GetInputImage",
-             [](TessBaseAPI &api) {
+             [](Pysseract &api) {
                  if (!api.GetThresholdedImageScaleFactor()) {
                      throw std::runtime_error("Please call SetImage before retrieving the input image.");
                  }
-                 Pix *pix = api.GetInputImage();
-                 l_int32 format = pixChooseOutputFormat(pix);
-                 l_uint8 *bytearr = NULL;
-                 size_t size = 0;
-                 pixWriteMem(&bytearr, &size, pix, format);
-                 if (bytearr == nullptr) throw std::runtime_error("Error returning the input image");
-                 std::string byteStr(bytearr, bytearr + size);
-                 return py::bytes(byteStr);
+                 return encodePix(api.GetInputImage(), api.Stats(), "Error returning the input image");
              },
              "Return the source image being considered by Tesseract")
+        .def("GetInputImageArray",
+             [](Pysseract &api, float scale, const Box *crop) {
+                 if (!api.GetThresholdedImageScaleFactor()) {
+                     throw std::runtime_error("Please call SetImage before retrieving the input image.");
+                 }
+                 Pix *pix;
+                 {
+                     py::gil_scoped_release release;
+                     pix = api.GetInputImage();
+                     if (pix == nullptr) throw std::runtime_error("Error returning the input image");
+                     pix = cropAndScale(pixClone(pix), crop, scale);
+                 }
+                 return pixToArray(pix);
+             },
+             py::arg("scale") = 1.0f, py::arg("crop") = py::none(), R"pbdoc(
+        Return the source image being considered by Tesseract as a uint8 NumPy array instead of encoded bytes.
+        Grayscale and binary images have shape (height, width), colour images (height, width, 3) or
+        (height, width, 4) and are a read-only view over Tesseract's own copy of the image when neither `crop`
+        nor `scale` is given. `crop` is a Box in image co-ordinates and is applied before scaling by `scale`.
+    )pbdoc")
         .def("GetIterator",
-             [](TessBaseAPI &api) {
-                 api.Recognize(nullptr);
+             [](Pysseract &api) {
+                 api.EnsureRecognized();
                  return api.GetIterator();
              },
-             "Returns the iterator over boxes found in a given source image")
+             py::call_guard<py::gil_scoped_release>(), "Returns the iterator over boxes found in a given source image")
+        .def("Recognize",
+             [](Pysseract &api, int timeoutMs, py::object progress) {
+                 RecognitionMonitor monitor(timeoutMs);
+                 std::exception_ptr progressError;
+                 if (!progress.is_none()) {
+                     monitor.SetProgress([&](int percent) {
+                         py::gil_scoped_acquire acquire;
+                         try {
+                             progress(percent);
+                         } catch (...) {
+                             progressError = std::current_exception();
+                             monitor.Cancel();
+                         }
+                     });
+                 }
+                 RecognitionMonitor::Outcome outcome;
+                 {
+                     py::gil_scoped_release release;
+                     outcome = monitor.Recognize(api);
+                 }
+                 if (progressError) std::rethrow_exception(progressError);
+                 if (outcome == RecognitionMonitor::TIMED_OUT) throw RecognitionTimeout(timeoutMs);
+                 if (outcome != RecognitionMonitor::DONE) throw std::runtime_error("Recognition failed");
+             },
+             py::arg("timeoutMs") = 0, py::arg("progress") = py::none(), R"pbdoc(
+        Recognise the current image. The text getters, GetIterator and friends reuse the results rather than
+        recognising the page again, so calling this first is how to bound the time spent on a page:
+
+        .. code-block:: python
+
+            try:
+                t.Recognize(timeoutMs=2000, progress=lambda percent: print(percent, '%'))
+                text = t.utf8Text
+            except pysseract.RecognitionTimeout:
+                ...
+
+        If `timeoutMs` is positive and the page is not done by then, recognition stops and RecognitionTimeout (a
+        TimeoutError) is raised; the partial results are discarded. `progress`, if given, is called with the
+        percentage done (0-100) as recognition advances; an exception raised by it stops recognition and
+        propagates.
+    )pbdoc")
+        .def("GetOutputs",
+             [](Pysseract &api, const std::vector<std::string> &formats, int timeoutMs) {
+                 for (const auto &format : formats) checkOutputFormat(format);
+                 std::vector<std::string> outputs;
+                 {
+                     py::gil_scoped_release release;
+                     RecognitionMonitor monitor(timeoutMs);
+                     RecognitionMonitor::Outcome outcome = monitor.Recognize(api);
+                     if (outcome == RecognitionMonitor::TIMED_OUT) throw RecognitionTimeout(timeoutMs);
+                     if (outcome != RecognitionMonitor::DONE) throw std::runtime_error("Recognition failed");
+                     for (const auto &format : formats) outputs.push_back(renderOutput(api, format));
+                 }
+                 py::dict result;
+                 for (size_t i = 0; i < formats.size(); i++) result[py::str(formats[i])] = py::str(outputs[i]);
+                 return result;
+             },
+             py::arg("formats"), py::arg("timeoutMs") = 0, R"pbdoc(
+        Recognise the current image once and render it in every one of `formats` ("text", "tsv", "hocr" and, with
+        Tesseract 4.1 or later, "alto") in a single call with the GIL released. Returns a dict mapping each format to
+        its output. Results already computed for the current image are reused; `timeoutMs` bounds the recognition
+        as in Recognize.
+
+        .. code-block:: python
+
+            outputs = t.GetOutputs(["text", "tsv", "hocr"])
+            print(outputs["tsv"])
+    )pbdoc")
+        .def("_RecognizeInBackground",
+             [](py::object self, py::function done, int timeoutMs, const std::string &format) {
+                 if (!format.empty()) checkOutputFormat(format);
+                 Pysseract *api = &self.cast<Pysseract &>();
+                 auto monitor = std::make_shared<RecognitionMonitor>(timeoutMs);
+                 // the worker holds on to the instance and the callback until it has reported back, and drops them
+                 // with the GIL held
+                 std::unique_ptr<py::object> keepAlive(new py::object(self));
+                 std::unique_ptr<py::function> callback(new py::function(done));
+                 py::object *instance = keepAlive.get();
+                 py::function *onDone = callback.get();
+                 BackgroundWorkers::instance().submit(monitor, [api, monitor, instance, onDone, format] {
+                     std::string status = "ok", payload;
+                     if (BackgroundWorkers::instance().stopping()) {
+                         status = "cancelled";
+                     } else {
+                         try {
+                             switch (monitor->Recognize(*api)) {
+                                 case RecognitionMonitor::DONE:
+                                     if (!format.empty()) payload = renderOutput(*api, format);
+                                     break;
+                                 case RecognitionMonitor::CANCELLED:
+                                     status = "cancelled";
+                                     break;
+                                 case RecognitionMonitor::TIMED_OUT:
+                                     status = "timeout";
+                                     break;
+                                 case RecognitionMonitor::FAILED:
+                                     status = "failed";
+                                     payload = "Recognition failed";
+                                     break;
+                             }
+                         } catch (const std::exception &e) {
+                             status = "failed";
+                             payload = e.what();
+                         }
+                     }
+
+                     py::gil_scoped_acquire acquire;
+                     // checked again under the GIL: work that was still running when shutdown started is never
+                     // reported, since the event loop is gone by then, so only the references are dropped
+                     if (!BackgroundWorkers::instance().stopping()) {
+                         try {
+                             bool rendered = status != "ok" || !format.empty();
+                             (*onDone)(status, rendered ? py::object(py::str(payload)) : py::object(py::none()));
+                         } catch (py::error_already_set &e) {
+                             e.restore();
+                             PyErr_WriteUnraisable(onDone->ptr());
+                         }
+                     }
+                     delete onDone;
+                     delete instance;
+                 });
+                 keepAlive.release();
+                 callback.release();
+                 return monitor;
+             },
+             py::arg("done"), py::arg("timeoutMs"), py::arg("format"), R"pbdoc(
+        Low-level helper behind RecognizeAsync and GetTextAsync. Recognise the current image on a native thread
+        and call `done(status, payload)` from that thread once finished, where status is one of "ok",
+        "cancelled", "timeout" or "failed" and payload is the page rendered in `format` (if not empty) or the
+        error message. Returns a RecognitionTask that can cancel the work. The instance must not be used until
+        `done` has been called. The native threads belong to the module and are joined at interpreter exit, which
+        cancels whatever is still running without calling `done`; await or cancel pending tasks before shutting
+        down the event loop.
+    )pbdoc")
+        .def("ExtractLevel",
+             [](Pysseract &api, PageIteratorLevel level, const std::vector<std::string> &fields) {
+                 bool boxes = false, confs = false, texts = false, parents = false;
+                 for (auto &&field : fields) {
+                     if (field == "box") {
+                         boxes = true;
+                     } else if (field == "conf") {
+                         confs = true;
+                     } else if (field == "text") {
+                         texts = true;
+                     } else if (field == "parents") {
+                         parents = true;
+                     } else {
+                         throw std::invalid_argument("Unknown field '" + field +
+                                                     "', expected one of box, conf, text or parents");
+                     }
+                 }
+
+                 LevelColumns cols;
+                 {
+                     py::gil_scoped_release release;
+                     api.EnsureRecognized();
+                     std::unique_ptr<ResultIterator> it(api.GetIterator());
+                     if (it) extractLevel(*it, level, boxes, confs, texts, parents, cols);
+                 }
+
+                 py::dict result;
+                 if (boxes) {
+                     result["left"] = vectorToArray(std::move(cols.left));
+                     result["top"] = vectorToArray(std::move(cols.top));
+                     result["width"] = vectorToArray(std::move(cols.width));
+                     result["height"] = vectorToArray(std::move(cols.height));
+                 }
+                 if (confs) result["conf"] = vectorToArray(std::move(cols.conf));
+                 if (texts) {
+                     result["text"] = py::bytes(cols.text);
+                     result["text_offsets"] = vectorToArray(std::move(cols.textOffsets));
+                 }
+                 if (parents) {
+                     if (level > tesseract::RIL_BLOCK) result["block"] = vectorToArray(std::move(cols.block));
+                     if (level > tesseract::RIL_PARA) result["para"] = vectorToArray(std::move(cols.para));
+                     if (level > tesseract::RIL_TEXTLINE) result["line"] = vectorToArray(std::move(cols.line));
+                 }
+                 return result;
+             },
+             py::arg("level"), py::arg("fields") = std::vector<std::string>{"box", "conf", "text"}, R"pbdoc(
+        Recognise the image and collect every element at the given PageIteratorLevel in a single native pass,
+        which is much faster than Pysseract.IterAt for WORD and SYMBOL levels on dense pages. The result is a
+        dict of NumPy arrays, one entry per element, holding only the requested `fields`:
+
+        - "box": int32 arrays "left", "top", "width" and "height" in image co-ordinates. Note that "top" is the
+          top edge, whereas the Box returned by ResultIterator.BoundingBox (and so by IterAt) holds the bottom edge
+          in its `top` field; for the same element, top == box.top - box.height
+        - "conf": float32 array "conf"
+        - "text": "text", all UTF-8 text concatenated into one bytes object, and int64 "text_offsets" of length
+          n + 1 such that element i is text[text_offsets[i]:text_offsets[i + 1]]
+        - "parents": int32 arrays "block", "para" and "line" with the 0-based index of the enclosing element,
+          for those levels that are above `level`
+
+        .. code-block:: python
+
+            cols = t.ExtractLevel(pysseract.PageIteratorLevel.WORD, ["box", "text"])
+            offsets = cols["text_offsets"]
+            words = [cols["text"][offsets[i]:offsets[i + 1]].decode() for i in range(len(offsets) - 1)]
+    )pbdoc")
+        .def("RecognizePages",
+             [](Pysseract &api, py::object source, std::vector<std::string> formats, int ppi, int timeoutMs) {
+                 if (formats.empty()) throw std::invalid_argument("RecognizePages needs at least one output format");
+                 for (auto &&format : formats) checkOutputFormat(format);
+                 return std::unique_ptr<PageStream>(new PageStream(api, source, std::move(formats), ppi, timeoutMs));
+             },
+             py::arg("source"), py::arg("formats") = std::vector<std::string>{"text"}, py::arg("ppi") = 0,
+             py::arg("timeoutMs") = 0, py::keep_alive<0, 1>(), R"pbdoc(
+        Recognise every page of a multi-page TIFF, given as a path or as encoded bytes, and yield the results page
+        by page through a PageStream. Files are memory-mapped and pages are decoded one at a time, the next one on a
+        background thread while the current one is recognised, so even long scans never need more than two decoded
+        pages in memory and no splitting into temporary files. Other image formats yield a single page.
+
+        .. code-block:: python
+
+            with t.RecognizePages("scan.tif", formats=["text", "hocr"]) as pages:
+                for page in pages:
+                    if page["error"] is None:
+                        print(page["index"], page["text"])
+
+        `formats`, `ppi` and `timeoutMs` work as for OcrBatch. A page that fails is reported through its "error"
+        entry; a page that cannot be decoded also ends the stream. The instance must not be used for anything else
+        until the stream is exhausted or closed.
+    )pbdoc")
+        .def("RecognizeRegions",
+             [](Pysseract &api, const std::vector<Box> &boxes, py::object psm, PysseractPool *pool) {
+                 if (!api.GetThresholdedImageScaleFactor()) {
+                     throw std::runtime_error("Please call SetImage before recognising regions.");
+                 }
+                 int mode = psm.is_none() ? -1 : psm.cast<PageSegMode>();
+                 RegionResults results;
+                 {
+                     py::gil_scoped_release release;
+                     results = recognizeRegions(api, boxes, mode, pool);
+                 }
+                 py::dict result;
+                 result["text"] = py::cast(results.text);
+                 result["conf"] = vectorToArray(std::move(results.conf));
+                 return result;
+             },
+             py::arg("boxes"), py::arg("psm") = py::none(), py::arg("pool") = py::none(), R"pbdoc(
+        Recognise many regions of the current image, such as the fields of a form, in one call. The image is
+        thresholded once and each Box (in image co-ordinates) is then recognised natively, which is much faster
+        than calling SetRectangle and reading utf8Text for every field. Regions are cut out of the binary image of
+        the whole page but still recognised from the original pixels. Returns a dict with "text", a list of the
+        UTF-8 text of each region, and "conf", an int32 NumPy array of their mean confidences (0-100), both in the
+        order of `boxes`.
+
+        Each Box's `top` is its top edge, as for SetRectangle. Boxes from ResultIterator.BoundingBox and IterAt
+        hold the bottom edge in `top` (see ExtractLevel), so pass `Box(b.left, b.top - b.height, b.width,
+        b.height)` for those.
+
+        `psm` is the PageSegMode to use for the regions (for instance SINGLE_LINE for one-line fields) and
+        defaults to the current pageSegMode. With a PysseractPool as `pool`, whichever of its engines are idle
+        recognise regions in parallel with this one; they use the same page segmentation mode and resolution but
+        keep their own variables. Afterwards the image is set again, so any rectangle and results are reset.
+
+        .. code-block:: python
+
+            fields = [pysseract.Box(40, 100, 300, 30), pysseract.Box(40, 140, 300, 30)]
+            regions = t.RecognizeRegions(fields, psm=pysseract.PageSegMode.SINGLE_LINE)
+            for text, conf in zip(regions["text"], regions["conf"]):
+                print(conf, text)
+    )pbdoc")
         .def("GetThresholdedImage",
-             [](TessBaseAPI &api) {
+             [](Pysseract &api) {
                  if (!api.GetThresholdedImageScaleFactor()) {
                      throw std::runtime_error("Please call SetImage before retrieving the thresholded image.");
                  }
-                 Pix *pix = api.GetThresholdedImage();
-                 l_int32 format = pixChooseOutputFormat(pix);
-                 l_uint8 *bytearr = NULL;
-                 size_t size = 0;
-                 pixWriteMem(&bytearr, &size, pix, format);
-                 if (bytearr == nullptr) throw std::runtime_error("Error returning the thresholded image");
-                 std::string byteStr(bytearr, bytearr + size);
-                 pixDestroy(&pix);
-                 return py::bytes(byteStr);
+                 PixPtr pix;
+                 {
+                     py::gil_scoped_release release;
+                     pix.reset(api.GetThresholdedImage());
+                 }
+                 return encodePix(pix.get(), api.Stats(), "Error returning the thresholded image");
              },
              "Get a copy of the image Tesseract has after pre-processing is complete. This can only be called once you "
              "have called SetImage. Unlike the underlying function in Tesseract, this will return the image as a byte "
              "string rather than the underlying Leptonica Pix object.")
+        .def("GetThresholdedImageArray",
+             [](Pysseract &api, float scale, const Box *crop) {
+                 if (!api.GetThresholdedImageScaleFactor()) {
+                     throw std::runtime_error("Please call SetImage before retrieving the thresholded image.");
+                 }
+                 Pix *pix;
+                 {
+                     py::gil_scoped_release release;
+                     pix = api.GetThresholdedImage();
+                     if (pix == nullptr) throw std::runtime_error("Error returning the thresholded image");
+                     pix = cropAndScale(pix, crop, scale);
+                 }
+                 return pixToArray(pix);
+             },
+             py::arg("scale") = 1.0f, py::arg("crop") = py::none(), R"pbdoc(
+        Same as GetThresholdedImage, but return the binarised image as a uint8 NumPy array of shape
+        (height, width) holding 0 for black and 255 for white, without encoding it first. `crop` is a Box in
+        image co-ordinates and is applied before scaling by `scale`.
+    )pbdoc")
         .def("GetVariableAsString",
-             [](TessBaseAPI &api, const char *name) {
+             [](Pysseract &api, const char *name) {
                  STRING str;
                  bool res = api.GetVariableAsString(name, &str);
                  if (res) {
-                     return str.c_str();
+                     // copied before `str` goes out of scope
+                     return std::string(str.c_str());
                  }
-                 return "";
+                 return std::string();
              },
              "Get value of named variable as a string, if it exists.")
-        .def("SetSourceResolution", &TessBaseAPI::SetSourceResolution, py::arg("ppi"),
+        .def("SetSourceResolution",
+             [](Pysseract &api, int ppi) {
+                 api.DiscardResults();
+                 api.SetSourceResolution(ppi);
+             },
+             py::arg("ppi"),
              "Set the pixel-per-inch value for the source image")
         .def("SetImageFromPath",
-             [](TessBaseAPI &api, const char *imgpath) {
-                 Pix *image = pixRead(imgpath);
-                 api.SetImage(image);
+             [](Pysseract &api, const char *imgpath) {
+                 // SetImage keeps its own reference, so ours is dropped straight away
+                 PixPtr image;
+                 {
+                     StageTimer timer(api.Stats(), Stage::DECODE);
+                     image.reset(pixRead(imgpath));
+                 }
+                 if (!image) throw std::runtime_error(std::string("Failed to read the image at ") + imgpath);
+                 if (api.Stats().enabled()) api.Stats().add(Counter::BYTES_DECODED, nbytesInFile(imgpath));
+                 api.SetImage(image.get());
              },
-             py::arg("imgpath"), "Read an image from a given fully-qualified file path")
+             py::arg("imgpath"), py::call_guard<py::gil_scoped_release>(), "Read an image from a given fully-qualified file path")
         .def("SetImageFromBytes",
-             [](TessBaseAPI &api, const std::string &bytes) {
-                 Pix *image = pixReadMem((unsigned char *)bytes.data(), bytes.size());
-                 api.SetImage(image);
+             [](Pysseract &api, py::buffer bytes) {
+                 // decode straight from the caller's buffer instead of copying it first
+                 py::buffer_info info = bytes.request();
+                 checkEncodedBytes(info);
+                 py::gil_scoped_release release;
+                 const size_t size = info.size * info.itemsize;
+                 PixPtr image;
+                 {
+                     StageTimer timer(api.Stats(), Stage::DECODE);
+                     image.reset(pixReadMem(static_cast<const l_uint8 *>(info.ptr), size));
+                 }
+                 if (!image) throw std::runtime_error("Failed to decode the image");
+                 api.Stats().add(Counter::BYTES_DECODED, size);
+                 api.SetImage(image.get());
              },
-             py::arg("bytes"), "Read an image from a string of bytes")
-        .def("SetVariable", &TessBaseAPI::SetVariable, py::arg("name"), py::arg("value"),
+             py::arg("bytes"), "Read an image from a string of bytes or any other contiguous bytes-like object")
+        .def("SetImageFromArray",
+             [](Pysseract &api, py::buffer array, int ppi) {
+                 py::buffer_info info = array.request();
+                 PixelBuffer pixels = pixelBuffer(info);
+                 {
+                     // Tesseract copies the pixels into its own Pix, so the buffer only has to outlive this call
+                     py::gil_scoped_release release;
+                     api.SetImage(pixels.data, pixels.width, pixels.height, pixels.channels, pixels.bytesPerLine);
+                     if (ppi > 0) api.SetSourceResolution(ppi);
+                 }
+             },
+             py::arg("array"), py::arg("ppi") = 0, R"pbdoc(
+        Set the image from decoded uint8 pixels in any buffer-protocol object, such as a NumPy array, without an
+        encode/decode round trip. The array must be C-contiguous with shape (height, width) for grayscale or
+        (height, width, channels) with 1, 3 (RGB) or 4 (RGBA) channels. `ppi`, when positive, is passed on to
+        SetSourceResolution since raw pixels carry no resolution of their own.
+
+        .. code-block:: python
+
+            frame = numpy.zeros((480, 640, 3), dtype=numpy.uint8)
+            t.SetImageFromArray(frame, ppi=300)
+    )pbdoc")
+        .def("SetVariable",
+             [](Pysseract &api, const char *name, const char *value) {
+                 api.DiscardResults();
+                 return api.SetVariable(name, value);
+             },
+             py::arg("name"), py::arg("value"),
              "Note: Must be called after Init(). Only works for non-init variables.")
         .def("SetRectangle", &TessBaseAPI::SetRectangle, py::arg("left"), py::arg("top"), py::arg("width"),
              py::arg("height"), "Restrict recognition to a sub-rectangle of the image. Call after SetImage.");
@@ -262,6 +907,16 @@ PYBIND11_MODULE(_pysseract, m) {
         .value("COUNT", OcrEngineMode::OEM_COUNT, "Number of OEMs");
 
     py::class_<Box>(m, "Box", R"pbdoc(The bounding box structure)pbdoc")
+        .def(py::init([](int left, int top, int width, int height) {
+                 Box box;
+                 box.x = left;
+                 box.y = top;
+                 box.w = width;
+                 box.h = height;
+                 box.refcount = 1;
+                 return box;
+             }),
+             py::arg("left"), py::arg("top"), py::arg("width"), py::arg("height"))
         .def_readonly("left", &Box::x, "Leftmost co-ordinate of the box")
         .def_readonly("top", &Box::y, "Topmost co-ordinate of the box")
         .def_readonly("width", &Box::w, "Box width")
@@ -341,11 +996,21 @@ PYBIND11_MODULE(_pysseract, m) {
              "right-to-left).")
         .def("BlanksBeforeWord", &ResultIterator::BlanksBeforeWord,
              "Returns whether there are any blank spaces before the start of the current text object")
-        .def("GetUTF8Text", &ResultIterator::GetUTF8Text, py::arg("pageIterLv"),
+        .def("GetUTF8Text",
+             [](const ResultIterator &ri, const PageIteratorLevel &lv) { return takeText(ri.GetUTF8Text(lv)); },
+             py::arg("pageIterLv"),
              "Returns the text of the current object at the specified page hierarchy level in UTF-8 format")
         .def("Confidence", &ResultIterator::Confidence, py::arg("pageIterLv"),
              "Return the confidence level expressed by the model for the current object at the specified page "
              "hierarchy level");
+
+    bindPool(m);
+    bindBatch(m);
+    bindPages(m);
+
+    // join the async workers before the interpreter starts finalising
+    py::module::import("atexit").attr("register")(py::cpp_function([] { BackgroundWorkers::instance().shutdown(); }));
+
 /**
  * VERSION_INFO is set from setup.py
  **/
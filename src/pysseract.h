@@ -0,0 +1,75 @@
+#pragma once
+
+#include <leptonica/allheaders.h>
+#include <tesseract/baseapi.h>
+#include <tesseract/resultiterator.h>
+#include <memory>
+
+#include "stats.h"
+
+/**
+ * The engine behind the Python Pysseract class: a TessBaseAPI plus the few extra hooks the bindings need.
+ **/
+class Pysseract : public tesseract::TessBaseAPI {
+   public:
+    /**
+     * Throw away the recognition results while keeping the image, e.g. after a cancelled or timed-out Recognize
+     * left a partially recognised page behind.
+     **/
+    void DiscardResults() { ClearResults(); }
+
+    /**
+     * Whether the current image and rectangle have already been recognised. Tesseract itself clears its results
+     * on SetImage, SetRectangle, Clear and Init; the bindings call DiscardResults for the settings that change the
+     * outcome without doing so (page segmentation mode, resolution and variables).
+     **/
+    bool HasResults() const { return recognition_done_ && page_res_ != nullptr; }
+
+    /**
+     * Recognise the current image unless the results are still valid. Returns 0 on success like Recognize.
+     **/
+    int EnsureRecognized() { return HasResults() ? 0 : RecognizePage(nullptr); }
+
+    /**
+     * Recognize, split into separately timed thresholding, layout analysis and recognition stages when stats are
+     * being collected. Recognize picks up the binary image and the layout from the earlier stages.
+     **/
+    int RecognizePage(ETEXT_DESC *monitor) {
+        if (!stats_.enabled()) return Recognize(monitor);
+        {
+            StageTimer timer(stats_, Stage::THRESHOLD);
+            Pix *binary = GetThresholdedImage();
+            pixDestroy(&binary);
+        }
+        {
+            StageTimer timer(stats_, Stage::LAYOUT);
+            delete AnalyseLayout();
+        }
+        int res;
+        {
+            StageTimer timer(stats_, Stage::RECOGNITION);
+            res = Recognize(monitor);
+        }
+        if (res == 0) countResults();
+        return res;
+    }
+
+    EngineStats &Stats() { return stats_; }
+
+   private:
+    void countResults() {
+        uint64_t words = 0, symbols = 0;
+        std::unique_ptr<tesseract::ResultIterator> it(GetIterator());
+        if (it && !it->Empty(tesseract::RIL_SYMBOL)) {
+            do {
+                symbols++;
+                if (it->IsAtBeginningOf(tesseract::RIL_WORD)) words++;
+            } while (it->Next(tesseract::RIL_SYMBOL));
+        }
+        stats_.add(Counter::PAGES, 1);
+        stats_.add(Counter::WORDS, words);
+        stats_.add(Counter::SYMBOLS, symbols);
+    }
+
+    EngineStats stats_;
+};
@@ -1,3 +1,5 @@
+import asyncio
+
 from _pysseract import *
 
 
@@ -19,3 +21,64 @@ def iterAt(self, level: PageIteratorLevel):
 
 
 setattr(Pysseract, 'IterAt', iterAt)
+
+
+def _settle(future, status, payload):
+    if future.done():
+        return
+    if status == 'ok':
+        future.set_result(payload)
+    elif status == 'timeout':
+        future.set_exception(RecognitionTimeout('Recognition did not finish before its deadline'))
+    elif status == 'cancelled':
+        future.cancel()
+    else:
+        future.set_exception(RuntimeError(payload))
+
+
+async def _recognizeInBackground(self, timeout, format):
+    loop = asyncio.get_running_loop()
+    future = loop.create_future()
+
+    def done(status, payload):
+        loop.call_soon_threadsafe(_settle, future, status, payload)
+
+    timeoutMs = 0 if timeout is None else max(1, int(timeout * 1000))
+    task = self._RecognizeInBackground(done, timeoutMs, format)
+    try:
+        return await asyncio.shield(future)
+    except asyncio.CancelledError:
+        task.cancel()
+        # wait for Tesseract to stop so that the instance is free again once the cancellation propagates
+        await asyncio.wait([future])
+        raise
+
+
+async def recognizeAsync(self, timeout: float = None):
+    r'''
+    Recognise the current image on a native thread without blocking the event loop. Cancelling the awaiting task
+    stops Tesseract at the next word. The instance must not be used by anything else until this returns. Await or
+    cancel the task before the event loop closes: work still running at interpreter exit is cancelled and never
+    reported back.
+
+    :param float timeout: Optional deadline in seconds, after which recognition stops and
+        RecognitionTimeout is raised
+    '''
+    await _recognizeInBackground(self, timeout, '')
+
+
+async def getTextAsync(self, format: str = 'text', timeout: float = None):
+    r'''
+    Recognise the current image on a native thread without blocking the event loop and return it rendered as
+    "text", "tsv", "hocr" or "alto". Cancellation and `timeout` behave as in Pysseract.RecognizeAsync.
+
+    :param str format: The output format
+    :param float timeout: Optional deadline in seconds, after which recognition stops and
+        RecognitionTimeout is raised
+    :return: str
+    '''
+    return await _recognizeInBackground(self, timeout, format)
+
+
+setattr(Pysseract, 'RecognizeAsync', recognizeAsync)
+setattr(Pysseract, 'GetTextAsync', getTextAsync)
@@ -0,0 +1,138 @@
+#include "regions.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#include <tesseract/thresholder.h>
+
+using tesseract::ImageThresholder;
+using tesseract::PageSegMode;
+
+namespace {
+
+/**
+ * Thresholder that serves each rectangle from a binary image of the whole page computed beforehand, while the
+ * engine keeps the grey or colour input image that the LSTM recogniser reads. Falls back to Otsu if the image it is
+ * given does not match the binary one.
+ **/
+class RegionThresholder : public ImageThresholder {
+   public:
+    explicit RegionThresholder(Pix *binary) : binary_(pixClone(binary)) {}
+    ~RegionThresholder() override { pixDestroy(&binary_); }
+
+    bool ThresholdToPix(PageSegMode pageSegMode, Pix **pix) override {
+        if (pixGetWidth(binary_) != image_width_ || pixGetHeight(binary_) != image_height_) {
+            return ImageThresholder::ThresholdToPix(pageSegMode, pix);
+        }
+        BOX *rect = boxCreate(rect_left_, rect_top_, rect_width_, rect_height_);
+        *pix = pixClipRectangle(binary_, rect, nullptr);
+        boxDestroy(&rect);
+        return *pix != nullptr;
+    }
+
+   private:
+    Pix *binary_;
+};
+
+/**
+ * Shared state of the engines working through one RecognizeRegions call. Regions are handed out one at a time, so
+ * the engines stay busy even when some fields take much longer than others.
+ **/
+struct RegionWork {
+    const std::vector<Box> &boxes;
+    RegionResults &results;
+    std::atomic<size_t> next{0};
+    std::mutex mutex;
+    std::exception_ptr error;
+
+    RegionWork(const std::vector<Box> &boxes, RegionResults &results) : boxes(boxes), results(results) {}
+
+    void run(Pysseract &engine) {
+        try {
+            for (size_t i = next++; i < boxes.size(); i = next++) {
+                const Box &box = boxes[i];
+                engine.SetRectangle(box.x, box.y, box.w, box.h);
+                std::unique_ptr<char[]> text(engine.GetUTF8Text());
+                if (!text) throw std::runtime_error("Recognition failed");
+                results.text[i] = text.get();
+                results.conf[i] = engine.MeanTextConf();
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!error) error = std::current_exception();
+            next = boxes.size();
+        }
+    }
+};
+
+}  // namespace
+
+RegionResults recognizeRegions(Pysseract &api, const std::vector<Box> &boxes, int pageSegMode, PysseractPool *pool) {
+    RegionResults results;
+    results.text.resize(boxes.size());
+    results.conf.resize(boxes.size());
+    if (boxes.empty()) return results;
+
+    Pix *input = api.GetInputImage();
+    if (input == nullptr) throw std::runtime_error("Please call SetImage before recognising regions.");
+    Pix *original = pixClone(input);
+    const int ppi = api.GetSourceYResolution();
+    const PageSegMode originalMode = api.GetPageSegMode();
+    const PageSegMode mode = pageSegMode >= 0 ? static_cast<PageSegMode>(pageSegMode) : originalMode;
+
+    // threshold the whole page once; every region is cut from that binary image but recognised from the original
+    api.SetRectangle(0, 0, pixGetWidth(original), pixGetHeight(original));
+    Pix *binary = api.GetThresholdedImage();
+    if (binary == nullptr) {
+        pixDestroy(&original);
+        throw std::runtime_error("Error thresholding the image");
+    }
+    api.SetThresholder(new RegionThresholder(binary));
+    api.SetImage(original);
+    api.SetSourceResolution(ppi);
+    api.SetPageSegMode(mode);
+
+    // only borrow engines that are idle right now; the calling engine always takes part
+    std::vector<Pysseract *> helpers;
+    std::vector<PageSegMode> helperModes;
+    if (pool != nullptr) {
+        size_t wanted = std::min(pool->size(), boxes.size() - 1);
+        while (helpers.size() < wanted) {
+            Pysseract *engine = pool->acquire(0);
+            if (engine == nullptr) break;
+            helperModes.push_back(engine->GetPageSegMode());
+            engine->SetThresholder(new RegionThresholder(binary));
+            engine->SetImage(original);
+            engine->SetSourceResolution(ppi);
+            engine->SetPageSegMode(mode);
+            helpers.push_back(engine);
+        }
+    }
+
+    RegionWork work(boxes, results);
+    std::vector<std::thread> threads;
+    for (Pysseract *engine : helpers) threads.emplace_back([&work, engine] { work.run(*engine); });
+    work.run(api);
+    for (auto &&thread : threads) thread.join();
+    // Clear() keeps the thresholder and page segmentation mode, so put back what the next user of each engine expects
+    for (size_t i = 0; i < helpers.size(); i++) {
+        helpers[i]->SetThresholder(new ImageThresholder);
+        helpers[i]->SetPageSegMode(helperModes[i]);
+        pool->release(helpers[i]);
+    }
+
+    api.SetThresholder(new ImageThresholder);
+    api.SetImage(original);
+    api.SetSourceResolution(ppi);
+    api.SetPageSegMode(originalMode);
+    pixDestroy(&original);
+    pixDestroy(&binary);
+
+    if (work.error) std::rethrow_exception(work.error);
+    return results;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <leptonica/allheaders.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "pool.h"
+#include "pysseract.h"
+
+/**
+ * Text and mean confidence of each region passed to recognizeRegions, in the same order.
+ **/
+struct RegionResults {
+    std::vector<std::string> text;
+    std::vector<int32_t> conf;
+};
+
+/**
+ * Recognise each of `boxes` (in image co-ordinates, `y` being the top edge) in the current image of `api`. The image
+ * is thresholded once and every engine gets the same input Pix with a thresholder that cuts each region out of that
+ * binary image, so per-region cost is layout and recognition only and the LSTM still reads the original pixels.
+ * `pageSegMode` is used for the regions when not negative. With a `pool`, whichever of its engines are idle share
+ * the work. The image, resolution and page segmentation mode of `api` are restored afterwards, which resets any
+ * rectangle and recognition results. Must be called without holding the GIL.
+ **/
+RegionResults recognizeRegions(Pysseract &api, const std::vector<Box> &boxes, int pageSegMode, PysseractPool *pool);
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <tesseract/baseapi.h>
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "pysseract.h"
+#include "stats.h"
+
+/**
+ * Names of the output formats a recognised page can be rendered in by renderOutput.
+ **/
+inline const std::vector<std::string> &outputFormats() {
+    static const std::vector<std::string> formats = {"text", "tsv", "hocr",
+#if TESSERACT_VERSION >= (4 << 16 | 1 << 8)
+                                                     "alto"
+#endif
+    };
+    return formats;
+}
+
+/**
+ * The outcome of recognising one page of a batch or stream: its outputs by format, or why it failed.
+ **/
+struct PageResult {
+    size_t index;
+    bool failed = false;
+    std::string error;
+    std::vector<std::pair<std::string, std::string>> outputs;
+};
+
+inline void checkOutputFormat(const std::string &format) {
+    const auto &formats = outputFormats();
+    if (std::find(formats.begin(), formats.end(), format) == formats.end()) {
+        throw std::invalid_argument("Unknown output format '" + format + "'");
+    }
+}
+
+/**
+ * Render the current page in one of outputFormats(), recognising it first if that has not happened yet.
+ **/
+inline std::string renderOutput(Pysseract &api, const std::string &format) {
+    StageTimer timer(api.Stats(), Stage::RENDER);
+    std::unique_ptr<char[]> text;
+    if (format == "text") {
+        text.reset(api.GetUTF8Text());
+    } else if (format == "tsv") {
+        text.reset(api.GetTSVText(0));
+    } else if (format == "hocr") {
+        text.reset(api.GetHOCRText(0));
+#if TESSERACT_VERSION >= (4 << 16 | 1 << 8)
+    } else if (format == "alto") {
+        text.reset(api.GetAltoText(0));
+#endif
+    } else {
+        checkOutputFormat(format);
+    }
+    if (!text) throw std::runtime_error("Recognition failed");
+    std::string output(text.get());
+    api.Stats().add(Counter::BYTES_ENCODED, output.size());
+    return output;
+}
@@ -0,0 +1,84 @@
+#include "stats.h"
+
+#include <pybind11/stl.h>
+#include <string>
+#include <vector>
+
+namespace py = pybind11;
+
+StatsSnapshot &StatsSnapshot::operator+=(const StatsSnapshot &other) {
+    for (size_t s = 0; s < STAGE_COUNT; s++) {
+        StageTimes &mine = stages[s];
+        const StageTimes &theirs = other.stages[s];
+        mine.count += theirs.count;
+        mine.totalNs += theirs.totalNs;
+        if (theirs.maxNs > mine.maxNs) mine.maxNs = theirs.maxNs;
+        for (size_t b = 0; b < HISTOGRAM_BUCKETS; b++) mine.histogram[b] += theirs.histogram[b];
+    }
+    for (size_t c = 0; c < COUNTER_COUNT; c++) counters[c] += other.counters[c];
+    return *this;
+}
+
+void EngineStats::record(Stage stage, std::chrono::steady_clock::duration elapsed) {
+    const auto ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    StageTimes &times = stages_[static_cast<size_t>(stage)];
+    times.count.fetch_add(1, std::memory_order_relaxed);
+    times.totalNs.fetch_add(ns, std::memory_order_relaxed);
+    uint64_t max = times.maxNs.load(std::memory_order_relaxed);
+    while (ns > max && !times.maxNs.compare_exchange_weak(max, ns, std::memory_order_relaxed)) {
+    }
+    size_t bucket = 0;
+    for (uint64_t bound = 1000000; bucket + 1 < HISTOGRAM_BUCKETS && ns >= bound; bound *= 2) bucket++;
+    times.histogram[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+StatsSnapshot EngineStats::snapshot() const {
+    StatsSnapshot snap;
+    for (size_t s = 0; s < STAGE_COUNT; s++) {
+        const StageTimes &times = stages_[s];
+        snap.stages[s].count = times.count.load(std::memory_order_relaxed);
+        snap.stages[s].totalNs = times.totalNs.load(std::memory_order_relaxed);
+        snap.stages[s].maxNs = times.maxNs.load(std::memory_order_relaxed);
+        for (size_t b = 0; b < HISTOGRAM_BUCKETS; b++) {
+            snap.stages[s].histogram[b] = times.histogram[b].load(std::memory_order_relaxed);
+        }
+    }
+    for (size_t c = 0; c < COUNTER_COUNT; c++) snap.counters[c] = counters_[c].load(std::memory_order_relaxed);
+    return snap;
+}
+
+void EngineStats::reset() {
+    for (auto &&times : stages_) {
+        times.count = 0;
+        times.totalNs = 0;
+        times.maxNs = 0;
+        for (auto &&bucket : times.histogram) bucket = 0;
+    }
+    for (auto &&counter : counters_) counter = 0;
+}
+
+py::dict statsToDict(const StatsSnapshot &stats) {
+    static const char *stageNames[STAGE_COUNT] = {"decode", "threshold", "layout", "recognition", "render"};
+    static const char *counterNames[COUNTER_COUNT] = {"pages", "words", "symbols", "bytes_decoded",
+                                                      "bytes_encoded"};
+
+    py::dict result;
+    for (size_t c = 0; c < COUNTER_COUNT; c++) result[counterNames[c]] = stats.counters[c];
+
+    py::dict stages;
+    for (size_t s = 0; s < STAGE_COUNT; s++) {
+        const StatsSnapshot::StageTimes &times = stats.stages[s];
+        py::dict stage;
+        stage["count"] = times.count;
+        stage["total_ms"] = times.totalNs / 1e6;
+        stage["max_ms"] = times.maxNs / 1e6;
+        stage["histogram"] = std::vector<uint64_t>(times.histogram.begin(), times.histogram.end());
+        stages[stageNames[s]] = stage;
+    }
+    result["stages"] = stages;
+
+    std::vector<double> bounds;
+    for (size_t b = 0; b + 1 < HISTOGRAM_BUCKETS; b++) bounds.push_back(static_cast<double>(1 << b));
+    result["histogram_bounds_ms"] = bounds;
+    return result;
+}
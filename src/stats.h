@@ -0,0 +1,99 @@
+#pragma once
+
+#include <pybind11/pybind11.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * The stages a page goes through, in order. RECOGNITION covers Tesseract's word recognition only, since the
+ * thresholding and layout analysis it would otherwise do first are timed on their own.
+ **/
+enum class Stage { DECODE, THRESHOLD, LAYOUT, RECOGNITION, RENDER };
+constexpr size_t STAGE_COUNT = 5;
+
+enum class Counter { PAGES, WORDS, SYMBOLS, BYTES_DECODED, BYTES_ENCODED };
+constexpr size_t COUNTER_COUNT = 5;
+
+/**
+ * Durations are binned into powers of two: bucket i counts those under 2^i ms, the last bucket everything slower.
+ **/
+constexpr size_t HISTOGRAM_BUCKETS = 18;
+
+/**
+ * A plain copy of the numbers in an EngineStats; snapshots of several engines add up to a pool- or batch-wide view.
+ **/
+struct StatsSnapshot {
+    struct StageTimes {
+        uint64_t count = 0;
+        uint64_t totalNs = 0;
+        uint64_t maxNs = 0;
+        std::array<uint64_t, HISTOGRAM_BUCKETS> histogram{};
+    };
+    std::array<StageTimes, STAGE_COUNT> stages;
+    std::array<uint64_t, COUNTER_COUNT> counters{};
+
+    StatsSnapshot &operator+=(const StatsSnapshot &other);
+};
+
+/**
+ * Per-engine stage timings and counters. Collection is off by default, in which case every instrumented spot costs
+ * one relaxed atomic load. All updates are relaxed atomics, so a pool or batch can take snapshots while its workers
+ * are busy.
+ **/
+class EngineStats {
+   public:
+    EngineStats() { reset(); }
+    EngineStats(const EngineStats &) = delete;
+    EngineStats &operator=(const EngineStats &) = delete;
+
+    bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+    void setEnabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+
+    void record(Stage stage, std::chrono::steady_clock::duration elapsed);
+    void add(Counter counter, uint64_t n) {
+        if (enabled()) counters_[static_cast<size_t>(counter)].fetch_add(n, std::memory_order_relaxed);
+    }
+
+    StatsSnapshot snapshot() const;
+    void reset();
+
+   private:
+    struct StageTimes {
+        std::atomic<uint64_t> count;
+        std::atomic<uint64_t> totalNs;
+        std::atomic<uint64_t> maxNs;
+        std::array<std::atomic<uint64_t>, HISTOGRAM_BUCKETS> histogram;
+    };
+
+    std::atomic<bool> enabled_{false};
+    std::array<StageTimes, STAGE_COUNT> stages_;
+    std::array<std::atomic<uint64_t>, COUNTER_COUNT> counters_;
+};
+
+/**
+ * Times a stage from construction to destruction on the monotonic clock, if collection is enabled.
+ **/
+class StageTimer {
+   public:
+    StageTimer(EngineStats &stats, Stage stage) : stats_(stats.enabled() ? &stats : nullptr), stage_(stage) {
+        if (stats_ != nullptr) start_ = std::chrono::steady_clock::now();
+    }
+    ~StageTimer() {
+        if (stats_ != nullptr) stats_->record(stage_, std::chrono::steady_clock::now() - start_);
+    }
+    StageTimer(const StageTimer &) = delete;
+    StageTimer &operator=(const StageTimer &) = delete;
+
+   private:
+    EngineStats *stats_;
+    Stage stage_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+/**
+ * The dict returned by GetStats() on Pysseract, PysseractPool and OcrBatch.
+ **/
+pybind11::dict statsToDict(const StatsSnapshot &stats);
@@ -1,7 +1,18 @@
+import asyncio
+import os
+import struct
+import tempfile
+import time
+from concurrent.futures import ThreadPoolExecutor
 from pathlib import Path
-from unittest import TestCase
+from unittest import TestCase, skipIf
 
-import pysseract
+import numpy
+
+# keep Tesseract's own OpenMP threads out of the way of the scaling test
+os.environ.setdefault('OMP_THREAD_LIMIT', '1')
+
+import pysseract  # noqa: E402
 
 
 class PysseractTest(TestCase):
@@ -33,6 +44,37 @@ class PysseractTest(TestCase):
         self.assertListEqual(
             lines, ['The quick brown\n', 'fox jumps over\n', 'the lazy dog.\n'])
 
+    def testExtractLevel(self):
+        t = pysseract.Pysseract()
+        t.pageSegMode = pysseract.PageSegMode.SINGLE_BLOCK
+        t.SetImageFromPath(self.thisPath.with_name(
+            "002-quick-fox.jpg").as_posix())
+        t.SetSourceResolution(70)
+        LEVEL = pysseract.PageIteratorLevel.WORD
+        expected = list(t.IterAt(LEVEL))
+
+        cols = t.ExtractLevel(LEVEL, ["box", "conf", "text", "parents"])
+        offsets = cols["text_offsets"]
+        self.assertEqual(len(offsets), len(expected) + 1)
+        words = [cols["text"][offsets[i]:offsets[i + 1]].decode()
+                 for i in range(len(expected))]
+        self.assertListEqual(words, [text for _, text, _ in expected])
+        self.assertListEqual(list(cols["left"]), [box.left for box, _, _ in expected])
+        # Box.top from BoundingBox is really the bottom edge, ExtractLevel reports the actual top
+        self.assertListEqual(list(cols["top"]), [box.top - box.height for box, _, _ in expected])
+        self.assertListEqual(list(cols["width"]), [box.width for box, _, _ in expected])
+        self.assertListEqual(list(cols["height"]), [box.height for box, _, _ in expected])
+        numpy.testing.assert_allclose(cols["conf"], [conf for _, _, conf in expected], rtol=1e-5)
+        self.assertEqual(cols["left"].dtype, numpy.int32)
+        self.assertEqual(cols["conf"].dtype, numpy.float32)
+        self.assertListEqual(list(cols["line"]), [0, 0, 0, 1, 1, 1, 2, 2, 2])
+        self.assertTrue((cols["block"] == 0).all())
+
+        cols = t.ExtractLevel(pysseract.PageIteratorLevel.TEXTLINE, ["box"])
+        self.assertListEqual(sorted(cols.keys()), ["height", "left", "top", "width"])
+        with self.assertRaises(ValueError):
+            t.ExtractLevel(LEVEL, ["bogus"])
+
     def testNews(self):
         t = pysseract.Pysseract()
         t.pageSegMode = pysseract.PageSegMode.SINGLE_BLOCK
@@ -52,6 +94,130 @@ class PysseractTest(TestCase):
         self.assertEqual(len(boxes), len(confs))
         self.assertTrue('HEADLINE' in lines[-1])
 
+    def testGetOutputs(self):
+        t = pysseract.Pysseract()
+        t.SetImageFromPath(self.thisPath.with_name(
+            "001-helloworld.png").as_posix())
+        self.assertFalse(t.recognized)
+        outputs = t.GetOutputs(["text", "tsv", "hocr"])
+        self.assertTrue(t.recognized)
+        self.assertListEqual(sorted(outputs), ["hocr", "text", "tsv"])
+        self.assertEqual(outputs["text"], t.utf8Text)
+        self.assertEqual(outputs["tsv"], t.GetTSVText(0))
+        self.assertEqual(outputs["hocr"], t.GetHOCRText(0))
+        with self.assertRaises(ValueError):
+            t.GetOutputs(["pdf"])
+
+        t.pageSegMode = pysseract.PageSegMode.SINGLE_LINE
+        self.assertFalse(t.recognized)
+        t.GetIterator()
+        self.assertTrue(t.recognized)
+        t.SetSourceResolution(70)
+        self.assertFalse(t.recognized)
+
+    def testRecognizeRegions(self):
+        t = pysseract.Pysseract()
+        t.SetImageFromPath(self.thisPath.with_name(
+            "001-helloworld.png").as_posix())
+        height, width = t.GetInputImageArray().shape[:2]
+        whole = pysseract.Box(0, 0, width, height)
+        mode = t.pageSegMode
+        regions = t.RecognizeRegions([whole, whole], psm=pysseract.PageSegMode.SINGLE_LINE)
+        self.assertListEqual(regions["text"], ["Hello, World!\n"] * 2)
+        self.assertEqual(len(regions["conf"]), 2)
+        self.assertTrue((regions["conf"] > 0).all())
+        self.assertEqual(t.pageSegMode, mode)
+        self.assertEqual("Hello, World!\n", t.utf8Text)
+        self.assertListEqual(t.RecognizeRegions([])["text"], [])
+
+        pool = pysseract.PysseractPool(size=2)
+        with pool.checkout() as engine:
+            poolMode = engine.pageSegMode
+        regions = t.RecognizeRegions([whole] * 6, psm=pysseract.PageSegMode.SINGLE_LINE, pool=pool)
+        self.assertListEqual(regions["text"], ["Hello, World!\n"] * 6)
+        self.assertEqual(pool.available, 2)
+        leases = [pool.checkout(), pool.checkout()]
+        for lease in leases:
+            with lease as engine:
+                self.assertEqual(engine.pageSegMode, poolMode)
+
+    def testRecognizeRegionsMatchesRectangles(self):
+        t = pysseract.Pysseract()
+        t.pageSegMode = pysseract.PageSegMode.SINGLE_BLOCK
+        t.SetImageFromPath(self.thisPath.with_name(
+            '003-skynews.png').as_posix())
+        t.SetSourceResolution(70)
+        # IterAt's boxes hold the bottom edge in top
+        lines = [pysseract.Box(box.left, box.top - box.height, box.width, box.height)
+                 for box, _, _ in t.IterAt(pysseract.PageIteratorLevel.TEXTLINE)]
+        self.assertGreater(len(lines), 1)
+
+        t.pageSegMode = pysseract.PageSegMode.SINGLE_LINE
+        expected = []
+        for box in lines:
+            t.SetRectangle(box.left, box.top, box.width, box.height)
+            expected.append(t.utf8Text)
+        regions = t.RecognizeRegions(lines)
+        self.assertListEqual(regions["text"], expected)
+        self.assertTrue(any(text.strip() for text in expected))
+
+    def testStats(self):
+        t = pysseract.Pysseract()
+        helloPath = self.thisPath.with_name("001-helloworld.png").as_posix()
+        t.SetImageFromPath(helloPath)
+        t.utf8Text
+        self.assertFalse(t.collectStats)
+        self.assertEqual(t.GetStats()["pages"], 0)
+
+        t.collectStats = True
+        t.SetImageFromPath(helloPath)
+        text = t.utf8Text
+        t.GetTSVText(0)
+        stats = t.GetStats()
+        self.assertEqual(text, "Hello, World!\n")
+        self.assertEqual(stats["pages"], 1)
+        self.assertEqual(stats["words"], 2)
+        self.assertEqual(stats["symbols"], len("Hello,World!"))
+        self.assertEqual(stats["bytes_decoded"], os.path.getsize(helloPath))
+        self.assertGreater(stats["bytes_encoded"], len(text))
+        stages = stats["stages"]
+        for name in ("decode", "threshold", "layout", "recognition"):
+            self.assertEqual(stages[name]["count"], 1, name)
+        self.assertEqual(stages["render"]["count"], 2)
+        self.assertGreater(stages["recognition"]["total_ms"], 0)
+        self.assertEqual(sum(stages["recognition"]["histogram"]), 1)
+        self.assertEqual(len(stats["histogram_bounds_ms"]) + 1, len(stages["decode"]["histogram"]))
+
+        t.ResetStats()
+        self.assertEqual(t.GetStats()["pages"], 0)
+
+    def testSetImageFromBytes(self):
+        t = pysseract.Pysseract()
+        with open(self.thisPath.with_name("001-helloworld.png").as_posix(), 'rb') as f:
+            data = f.read()
+        t.SetImageFromBytes(memoryview(data))
+        self.assertEqual("Hello, World!\n", t.utf8Text)
+        with self.assertRaises(ValueError):
+            t.SetImageFromBytes(memoryview(data)[::-1])
+        with self.assertRaises(ValueError):
+            t.SetImageFromBytes(memoryview(data)[::2])
+
+    def testSetImageFromArray(self):
+        t = pysseract.Pysseract()
+        height, width = 40, 120
+        blank = memoryview(bytes([255] * height * width)).cast('B', (height, width))
+        t.SetImageFromArray(blank, ppi=300)
+        self.assertEqual("", t.utf8Text.strip())
+
+        rgb = memoryview(bytes([255] * height * width * 3)).cast('B', (height, width, 3))
+        t.SetImageFromArray(rgb)
+        self.assertEqual("", t.utf8Text.strip())
+
+        with self.assertRaises(ValueError):
+            t.SetImageFromArray(memoryview(bytes(2 * width * height)).cast('B', (height, width, 2)))
+        with self.assertRaises(ValueError):
+            t.SetImageFromArray(memoryview(bytes(height * width * 4)).cast('I', (height, width)))
+
     def testGetThresholdedImage(self):
         t = pysseract.Pysseract()
         t.pageSegMode = pysseract.PageSegMode.SINGLE_BLOCK
@@ -69,3 +235,403 @@ class PysseractTest(TestCase):
         with open(self.thisPath.with_name("003-result.png").as_posix(), 'rb') as f:
             expected = f.read()
         self.assertEqual(expected, t.GetInputImage())
+
+    def testGetInputImageArray(self):
+        t = pysseract.Pysseract()
+        t.SetImageFromPath(self.thisPath.with_name(
+            "001-helloworld.png").as_posix())
+        img = t.GetInputImageArray()
+        self.assertEqual(img.dtype, numpy.uint8)
+        self.assertIn(img.ndim, (2, 3))
+
+        t2 = pysseract.Pysseract()
+        t2.SetImageFromArray(numpy.ascontiguousarray(img))
+        self.assertEqual("Hello, World!\n", t2.utf8Text)
+
+        half = t.GetInputImageArray(scale=0.5)
+        self.assertAlmostEqual(half.shape[0], img.shape[0] / 2, delta=1)
+        self.assertAlmostEqual(half.shape[1], img.shape[1] / 2, delta=1)
+
+        crop = t.GetInputImageArray(crop=pysseract.Box(2, 3, 20, 10))
+        self.assertEqual(crop.shape[:2], (10, 20))
+        numpy.testing.assert_array_equal(crop, img[3:13, 2:22])
+
+    def testGetThresholdedImageArray(self):
+        t = pysseract.Pysseract()
+        t.pageSegMode = pysseract.PageSegMode.SINGLE_BLOCK
+        t.SetImageFromPath(self.thisPath.with_name(
+            "003-skynews.png").as_posix())
+        img = t.GetThresholdedImageArray()
+        self.assertEqual(img.ndim, 2)
+        self.assertEqual(img.shape, t.GetInputImageArray().shape[:2])
+        self.assertTrue(set(numpy.unique(img)) <= {0, 255})
+
+        crop = t.GetThresholdedImageArray(scale=0.5, crop=pysseract.Box(0, 0, 40, 20))
+        self.assertEqual(crop.shape, (10, 20))
+
+
+class PysseractMonitorTest(TestCase):
+
+    thisPath = Path(__file__)
+
+    def setUp(self):
+        self.loop = asyncio.new_event_loop()
+        self.t = pysseract.Pysseract()
+        self.t.pageSegMode = pysseract.PageSegMode.SINGLE_BLOCK
+        self.t.SetImageFromPath(self.thisPath.with_name(
+            "003-skynews.png").as_posix())
+        self.t.SetSourceResolution(70)
+
+    def tearDown(self):
+        self.loop.close()
+
+    def testRecognizeAsync(self):
+        expected = pysseract.Pysseract()
+        expected.pageSegMode = pysseract.PageSegMode.SINGLE_BLOCK
+        expected.SetImageFromPath(self.thisPath.with_name(
+            "003-skynews.png").as_posix())
+        expected.SetSourceResolution(70)
+
+        self.loop.run_until_complete(self.t.RecognizeAsync())
+        self.assertEqual(expected.utf8Text, self.t.utf8Text)
+        tsv = self.loop.run_until_complete(self.t.GetTextAsync("tsv"))
+        self.assertEqual(expected.GetTSVText(0), tsv)
+
+    def testTimeout(self):
+        with self.assertRaises(TimeoutError):
+            self.loop.run_until_complete(self.t.GetTextAsync(timeout=0.001))
+        # the instance is usable again and recognises the page from scratch
+        self.assertIn("HEADLINE", self.t.utf8Text)
+
+    def testCancel(self):
+        async def cancelSoon():
+            task = asyncio.ensure_future(self.t.GetTextAsync())
+            await asyncio.sleep(0.001)
+            task.cancel()
+            await task
+
+        with self.assertRaises(asyncio.CancelledError):
+            self.loop.run_until_complete(cancelSoon())
+        self.assertIn("HEADLINE", self.t.utf8Text)
+
+    def testRecognizeTimeout(self):
+        with self.assertRaises(pysseract.RecognitionTimeout):
+            self.t.Recognize(timeoutMs=1)
+        self.assertTrue(issubclass(pysseract.RecognitionTimeout, TimeoutError))
+
+    def testRecognizeProgress(self):
+        progress = []
+        self.t.Recognize(timeoutMs=60000, progress=progress.append)
+        self.assertEqual(progress[-1], 100)
+        self.assertListEqual(progress, sorted(progress))
+        self.assertIn("HEADLINE", self.t.utf8Text)
+
+    def testProgressError(self):
+        def fail(percent):
+            raise KeyError(percent)
+
+        with self.assertRaises(KeyError):
+            self.t.Recognize(progress=fail)
+
+    def testUnknownFormat(self):
+        with self.assertRaises(ValueError):
+            self.loop.run_until_complete(self.t.GetTextAsync("pdf"))
+
+
+class PysseractPoolTest(TestCase):
+
+    thisPath = Path(__file__)
+
+    def testCheckout(self):
+        pool = pysseract.PysseractPool(size=2)
+        self.assertEqual(pool.size, 2)
+        self.assertEqual(pool.available, 2)
+        leases = [pool.checkout(), pool.checkout()]
+        dataPaths = []
+        for lease in leases:
+            with lease as t:
+                dataPaths.append(t.dataPath)
+        self.assertEqual(dataPaths[0], dataPaths[1])
+        with pool.checkout() as t:
+            self.assertEqual(pool.available, 1)
+            t.SetImageFromPath(self.thisPath.with_name(
+                "001-helloworld.png").as_posix())
+            self.assertEqual("Hello, World!\n", t.utf8Text)
+        self.assertEqual(pool.available, 2)
+
+    def testTimeout(self):
+        pool = pysseract.PysseractPool(size=1)
+        lease = pool.checkout()
+        with self.assertRaises(RuntimeError):
+            pool.checkout(timeout=0.01)
+        lease.release()
+        with pool.checkout(timeout=0.01) as t:
+            t.SetImageFromPath(self.thisPath.with_name(
+                "001-helloworld.png").as_posix())
+            self.assertEqual("Hello, World!\n", t.utf8Text)
+
+    def testThreaded(self):
+        pool = pysseract.PysseractPool(size=2)
+
+        def ocr(_):
+            with pool.checkout() as t:
+                t.SetImageFromPath(self.thisPath.with_name(
+                    "001-helloworld.png").as_posix())
+                return t.utf8Text
+
+        with ThreadPoolExecutor(4) as executor:
+            texts = list(executor.map(ocr, range(8)))
+        self.assertListEqual(texts, ["Hello, World!\n"] * 8)
+        self.assertEqual(pool.available, 2)
+
+    def testStats(self):
+        pool = pysseract.PysseractPool(size=2, collectStats=True)
+        for _ in range(3):
+            with pool.checkout() as t:
+                t.SetImageFromPath(self.thisPath.with_name(
+                    "001-helloworld.png").as_posix())
+                t.GetOutputs(["text", "hocr"])
+        stats = pool.GetStats()
+        self.assertEqual(stats["pages"], 3)
+        self.assertEqual(stats["stages"]["render"]["count"], 6)
+        pool.ResetStats()
+        self.assertEqual(pool.GetStats()["pages"], 0)
+
+
+def multipageTiff(pages):
+    """Encode 2-D uint8 arrays as an uncompressed grayscale multi-page TIFF."""
+    data = bytearray(b'II*\x00\x00\x00\x00\x00')
+    link = 4
+    for page in pages:
+        height, width = page.shape
+        strip = len(data)
+        data += page.tobytes()
+        if len(data) % 2:
+            data += b'\x00'
+        struct.pack_into('<I', data, link, len(data))
+        entries = [(256, 4, width), (257, 4, height), (258, 3, 8), (259, 3, 1), (262, 3, 1),
+                   (273, 4, strip), (277, 3, 1), (278, 4, height), (279, 4, width * height)]
+        data += struct.pack('<H', len(entries))
+        for tag, kind, value in entries:
+            data += struct.pack('<HHII', tag, kind, 1, value) if kind == 4 else \
+                struct.pack('<HHIHH', tag, kind, 1, value, 0)
+        link = len(data)
+        data += b'\x00\x00\x00\x00'
+    return bytes(data)
+
+
+class PysseractPagesTest(TestCase):
+
+    thisPath = Path(__file__)
+
+    def setUp(self):
+        self.t = pysseract.Pysseract()
+        self.helloPath = self.thisPath.with_name("001-helloworld.png")
+        self.t.SetImageFromPath(self.helloPath.as_posix())
+        pixels = self.t.GetInputImageArray()
+        if pixels.ndim == 3:
+            pixels = pixels[:, :, :3].mean(axis=2).astype(numpy.uint8)
+        blank = numpy.full_like(pixels, 255)
+        self.tiff = multipageTiff([pixels, blank, pixels])
+
+    def testBytes(self):
+        pages = list(self.t.RecognizePages(self.tiff, formats=["text", "tsv"]))
+        self.assertListEqual([page["index"] for page in pages], [0, 1, 2])
+        self.assertListEqual([page["error"] for page in pages], [None] * 3)
+        self.assertListEqual([page["text"].strip() for page in pages], ["Hello, World!", "", "Hello, World!"])
+        self.assertTrue(all("tsv" in page for page in pages))
+
+    def testPath(self):
+        with tempfile.TemporaryDirectory() as tmp:
+            path = os.path.join(tmp, "scan.tif")
+            with open(path, 'wb') as f:
+                f.write(self.tiff)
+            with self.t.RecognizePages(Path(path)) as pages:
+                self.assertEqual(next(pages)["text"], "Hello, World!\n")
+            self.assertListEqual(list(pages), [])
+
+    def testSinglePage(self):
+        pages = list(self.t.RecognizePages(self.helloPath.as_posix()))
+        self.assertEqual(len(pages), 1)
+        self.assertEqual(pages[0]["text"], "Hello, World!\n")
+
+    def testInvalid(self):
+        with self.assertRaises(ValueError):
+            self.t.RecognizePages(self.tiff, formats=["pdf"])
+        with self.assertRaises(RuntimeError):
+            self.t.RecognizePages(self.thisPath.with_name("missing.tif").as_posix())
+        with self.assertRaises(ValueError):
+            self.t.RecognizePages(memoryview(self.tiff)[::-1])
+        pages = list(self.t.RecognizePages(b"not an image"))
+        self.assertEqual(len(pages), 1)
+        self.assertIsNotNone(pages[0]["error"])
+
+
+class OcrBatchTest(TestCase):
+
+    thisPath = Path(__file__)
+
+    def pages(self):
+        helloPath = self.thisPath.with_name("001-helloworld.png")
+        with open(helloPath.as_posix(), 'rb') as f:
+            helloBytes = f.read()
+        t = pysseract.Pysseract()
+        t.SetImageFromPath(helloPath.as_posix())
+        helloArray = numpy.ascontiguousarray(t.GetInputImageArray())
+        return [helloPath.as_posix(), helloBytes, helloArray, helloPath]
+
+    def testOrdered(self):
+        batch = pysseract.OcrBatch(threads=2, ordered=True, queueDepth=1)
+        results = list(batch.run(self.pages() * 3))
+        self.assertListEqual([r["index"] for r in results], list(range(12)))
+        for r in results:
+            self.assertIsNone(r["error"])
+            self.assertEqual("Hello, World!\n", r["text"])
+
+    def testUnorderedWithErrors(self):
+        batch = pysseract.OcrBatch(threads=3, formats=["text", "tsv"])
+        pages = self.pages() + [b"not an image", "/no/such/file.png"]
+        results = sorted(batch.run(pages), key=lambda r: r["index"])
+        self.assertEqual(len(results), len(pages))
+        for r in results[:4]:
+            self.assertIsNone(r["error"])
+            self.assertEqual("Hello, World!\n", r["text"])
+            self.assertIn("Hello", r["tsv"])
+        for r in results[4:]:
+            self.assertIsNotNone(r["error"])
+            self.assertNotIn("text", r)
+
+        # the batch is reusable once a run is exhausted
+        self.assertEqual(len(list(batch.run(self.pages()))), 4)
+
+    def testClose(self):
+        batch = pysseract.OcrBatch(threads=2, queueDepth=1)
+        with batch.run(self.pages() * 4) as run:
+            next(run)
+            with self.assertRaises(RuntimeError):
+                batch.run(self.pages())
+        self.assertEqual(len(list(batch.run([]))), 0)
+
+    def testTimeout(self):
+        batch = pysseract.OcrBatch(threads=1, timeoutMs=1, pageSegMode=pysseract.PageSegMode.SINGLE_BLOCK)
+        page, = batch.run([self.thisPath.with_name("003-skynews.png").as_posix()])
+        self.assertIn("did not finish", page["error"])
+
+    def testInvalidArguments(self):
+        with self.assertRaises(ValueError):
+            pysseract.OcrBatch(threads=1, formats=["pdf"])
+        batch = pysseract.OcrBatch(threads=1)
+        with self.assertRaises(TypeError):
+            batch.run([42])
+        with self.assertRaises(ValueError):
+            batch.run([memoryview(self.pages()[1])[::-1]])
+
+
+class PysseractThreadingTest(TestCase):
+
+    thisPath = Path(__file__)
+    nThreads = min(os.cpu_count() or 1, 4)
+    pagesPerThread = 3
+
+    def newEngine(self):
+        t = pysseract.Pysseract()
+        t.pageSegMode = pysseract.PageSegMode.SINGLE_BLOCK
+        return t
+
+    def ocrPages(self, t, n):
+        texts = []
+        for _ in range(n):
+            t.SetImageFromPath(self.thisPath.with_name(
+                '003-skynews.png').as_posix())
+            t.SetSourceResolution(70)
+            texts.append(t.utf8Text)
+        return texts
+
+    def testThreadedResultsMatch(self):
+        expected = self.ocrPages(self.newEngine(), 1)[0]
+        engines = [self.newEngine() for _ in range(self.nThreads)]
+        with ThreadPoolExecutor(self.nThreads) as pool:
+            results = list(pool.map(self.ocrPages, engines, [1] * self.nThreads))
+        for texts in results:
+            self.assertEqual(texts, [expected])
+
+    # wall-clock speedups are unreliable on shared machines, so this only runs on request; see also
+    # benchmarks/bench.py --only scaling
+    @skipIf(not os.environ.get('PYSSERACT_SCALING_TEST'), "set PYSSERACT_SCALING_TEST=1 to run")
+    @skipIf(nThreads < 2, "needs at least two cores")
+    def testThreadedScaling(self):
+        # initialise every engine and warm it up up front, so that only recognition is timed
+        engines = [self.newEngine() for _ in range(self.nThreads)]
+        for t in engines:
+            self.ocrPages(t, 1)
+
+        start = time.perf_counter()
+        self.ocrPages(engines[0], self.nThreads * self.pagesPerThread)
+        serial = time.perf_counter() - start
+
+        start = time.perf_counter()
+        with ThreadPoolExecutor(self.nThreads) as pool:
+            list(pool.map(self.ocrPages, engines, [self.pagesPerThread] * self.nThreads))
+        threaded = time.perf_counter() - start
+
+        speedup = serial / threaded
+        self.assertGreater(speedup, 0.5 * self.nThreads,
+                           "speedup {:.2f} with {} threads".format(speedup, self.nThreads))
+
+
+@skipIf(not os.path.exists('/proc/self/statm'), "needs /proc to measure RSS")
+class PysseractLeakTest(TestCase):
+
+    thisPath = Path(__file__)
+    # well above allocator noise, well below what one leaked page per round adds up to
+    maxGrowth = 16 << 20
+
+    def rss(self):
+        with open('/proc/self/statm') as f:
+            return int(f.read().split()[1]) * os.sysconf('SC_PAGE_SIZE')
+
+    def assertNoGrowth(self, step, rounds):
+        for _ in range(rounds // 10):
+            step()
+        before = self.rss()
+        for _ in range(rounds):
+            step()
+        growth = self.rss() - before
+        self.assertLess(growth, self.maxGrowth, "RSS grew by {} bytes over {} rounds".format(growth, rounds))
+
+    def testImageLoading(self):
+        t = pysseract.Pysseract()
+        paths = [p.as_posix() for p in sorted(self.thisPath.parent.iterdir()) if p.suffix in ('.png', '.jpg')]
+        encoded = []
+        for path in paths:
+            with open(path, 'rb') as f:
+                encoded.append(f.read())
+
+        def step():
+            for path, data in zip(paths, encoded):
+                t.SetImageFromPath(path)
+                t.SetImageFromBytes(data)
+            t.GetInputImage()
+
+        self.assertNoGrowth(step, 300)
+
+    def testThresholdedImage(self):
+        t = pysseract.Pysseract()
+        t.SetImageFromPath(self.thisPath.with_name("001-helloworld.png").as_posix())
+        self.assertNoGrowth(t.GetThresholdedImage, 10000)
+
+    def testTextGetters(self):
+        t = pysseract.Pysseract()
+        t.SetImageFromPath(self.thisPath.with_name("001-helloworld.png").as_posix())
+        t.Recognize()
+        level = pysseract.PageIteratorLevel.WORD
+
+        def step():
+            t.utf8Text
+            t.unlvText
+            t.GetHOCRText(0)
+            t.GetTSVText(0)
+            for _ in t.IterAt(level):
+                pass
+
+        self.assertNoGrowth(step, 10000)